@@ -1,9 +1,12 @@
 #include "AccessController.hpp"
 #include "core/Logger.hpp"
+#include "core/InputTrace.hpp"
+#include "core/Metrics.hpp"
+#include "app/AppBus.hpp"
 
-void AccessController::begin(Barrier* barrier, SlotManager* slots,
+void AccessController::begin(Barrier* barrier, ParkingSlots* slots,
                             Button* btnVip, Button* btnCarga, Button* btnReg, Button* btnExit,
-                            ProximitySensor* safe) {
+                            ProximitySensor* safe, ProximitySensor* pass) {
   barrier_ = barrier;
   slots_ = slots;
   btnVip_ = btnVip;
@@ -11,9 +14,9 @@ void AccessController::begin(Barrier* barrier, SlotManager* slots,
   btnReg_ = btnReg;
   btnExit_ = btnExit;
   safe_ = safe;
+  pass_ = pass ? pass : safe;
   
   state_ = State::IDLE;
-  lastLoggedState_ = state_;
   stateStartMs_ = millis();
   assignedSlot_ = -1;
   isExitOperation_ = false;
@@ -27,13 +30,20 @@ void AccessController::begin(Barrier* barrier, SlotManager* slots,
 void AccessController::update(uint32_t nowMs) {
   if (!initialized_) return;
 
-  // Leer estado del sensor de seguridad (con anti-spam logging)
-  bool safeSensorActive = safe_->isDetected(nowMs);
+  // Estado del sensor de seguridad (muestreado en el tick): publicar cambios
+  bool safeSensorActive = safe_->isDetected();
   if (safeSensorActive != safeSensorLastState_) {
-    LOG_INFO("Safety sensor: %s", safeSensorActive ? "ACTIVE" : "INACTIVE");
+    if (safeSensorActive) {
+      AppBus::publish(Events::SafetySensorActivated{nowMs});
+    } else {
+      AppBus::publish(Events::SafetySensorDeactivated{nowMs});
+    }
     safeSensorLastState_ = safeSensorActive;
   }
 
+  // Pulsaciones a la cola, en cualquier estado
+  pollButtons(nowMs);
+
   // Ejecutar handler del estado actual
   switch (state_) {
     case State::IDLE:
@@ -57,17 +67,80 @@ void AccessController::update(uint32_t nowMs) {
   }
 }
 
+uint32_t AccessController::msUntilNext(uint32_t nowMs) const {
+  if (!initialized_) return kNoDeadline;
+  
+  uint32_t elapsed = getStateTime(nowMs);
+  auto remaining = [elapsed](uint32_t timeoutMs) {
+    // update() actúa cuando elapsed > timeout
+    return elapsed > timeoutMs ? 0 : timeoutMs - elapsed + 1;
+  };
+  
+  switch (state_) {
+    case State::IDLE:
+      // Pedido encolado mientras estaba ocupado: atenderlo ya
+      return queue_.empty() ? kNoDeadline : 0;
+    case State::CHECK_CAPACITY:
+      return 0;
+    case State::OPENING:
+      return barrier_->isOpen() ? 0 : remaining(openTimeoutMs_);
+    case State::WAIT_PASS:
+      return remaining(passTimeMs_);
+    case State::CLOSING:
+      if (barrier_->isOpen() || barrier_->getState() == BarrierState::OPENING) {
+        // Reabierta por seguridad: el cambio del sensor o la llegada a
+        // OPEN despiertan el lazo; si no, la cota de espera
+        return barrier_->isOpen() && !safe_->isDetected() ? 0 : remaining(Cfg::kSafetyHoldMs);
+      }
+      return barrier_->isClosed() ? 0 : remaining(closeTimeoutMs_);
+    case State::FAULT: {
+      uint32_t sinceLog = nowMs - lastFaultLogMs_;
+      return sinceLog > kFaultLogMs ? 0 : kFaultLogMs - sinceLog + 1;
+    }
+  }
+  return kNoDeadline;
+}
+
 void AccessController::reset() {
   if (state_ == State::FAULT) {
     LOG_INFO("Manual reset from FAULT state");
+    InputTrace::mark(InputTrace::MARK_RESET);   // host/replay la repite
     setState(State::IDLE, millis());
     assignedSlot_ = -1;
     isExitOperation_ = false;
+    
+    // Los pedidos previos a la falla ya no corresponden a quien espera
+    size_t discarded = queue_.clear();
+    if (discarded > 0) {
+      LOG_WARN("Discarded %d queued requests after fault", discarded);
+    }
   }
 }
 
+uint32_t AccessController::vehiclesPerHour(uint32_t nowMs) const {
+  if (nowMs == 0) return 0;
+  uint64_t served = static_cast<uint64_t>(stats_.entries) + stats_.exits;
+  return static_cast<uint32_t>(served * 3600000ULL / nowMs);
+}
+
+void AccessController::printStats(uint32_t nowMs) const {
+  const auto& q = queue_.stats();
+  LOG_INFO("Requests: %u entries, %u exits, %u chained, %u denied, %u dropped",
+           (unsigned)stats_.entries, (unsigned)stats_.exits, (unsigned)stats_.chained,
+           (unsigned)stats_.denied, (unsigned)q.dropped);
+  LOG_INFO("Queue: depth %u (max %u), %u arrived busy, wait avg %u ms, max %u ms",
+           (unsigned)queue_.size(), (unsigned)q.maxDepth, (unsigned)stats_.arrivedBusy,
+           (unsigned)queue_.avgWaitMs(), (unsigned)q.maxWaitMs);
+  LOG_INFO("Throughput: %u vehicles/h", (unsigned)vehiclesPerHour(nowMs));
+  LOG_INFO("Gate: %u cycles, avg %u ms, max %u ms; %u passages, %u pass timeouts",
+           (unsigned)stats_.cycles,
+           stats_.cycles ? (unsigned)(stats_.totalCycleMs / stats_.cycles) : 0u,
+           (unsigned)stats_.maxCycleMs, (unsigned)stats_.passages, (unsigned)stats_.passTimeouts);
+}
+
 void AccessController::emergencyStop() {
   LOG_WARN("Emergency stop triggered");
+  AppBus::publish(Events::SystemFault{"Emergency stop", millis()});
   barrier_->stop();
   setState(State::FAULT, millis());
 }
@@ -87,32 +160,22 @@ const char* AccessController::getStateName() const {
 // Private methods - State handlers
 
 void AccessController::handleIdle(uint32_t nowMs) {
-  // Verificar botones de entrada
-  if (btnVip_->wasPressed()) {
-    requestEntry(VehicleClass::VIP, nowMs);
-    return;
-  }
+  // Atender el pedido de mayor prioridad (la capacidad se verifica ahora)
+  AccessRequest req;
+  if (!queue_.pop(req, nowMs)) return;
   
-  if (btnCarga_->wasPressed()) {
-    requestEntry(VehicleClass::CARGA, nowMs);
-    return;
-  }
-  
-  if (btnReg_->wasPressed()) {
-    requestEntry(VehicleClass::REGULAR, nowMs);
-    return;
-  }
-  
-  // Verificar botón de salida
-  if (btnExit_->wasPressed()) {
+  requestMs_ = req.enqueuedMs;
+  if (req.exit) {
     requestExit(nowMs);
-    return;
+  } else {
+    requestEntry(req.vehicleClass, nowMs);
   }
 }
 
 void AccessController::handleCheckCapacity(uint32_t nowMs) {
   // Para salida, siempre permitir
   if (isExitOperation_) {
+    stats_.exits++;
     setState(State::OPENING, nowMs);
     barrier_->open();
     return;
@@ -124,6 +187,7 @@ void AccessController::handleCheckCapacity(uint32_t nowMs) {
   if (slot >= 0) {
     // Hay espacio disponible
     assignedSlot_ = slot;
+    stats_.entries++;
     setState(State::OPENING, nowMs);
     barrier_->open();
     
@@ -133,10 +197,7 @@ void AccessController::handleCheckCapacity(uint32_t nowMs) {
              slot);
   } else {
     // Sin espacio disponible
-    LOG_WARN("Access denied for %s - no available slots", 
-             pendingClass_ == VehicleClass::VIP ? "VIP" :
-             pendingClass_ == VehicleClass::CARGA ? "CARGA" : "REGULAR");
-    
+    deny(pendingClass_, nowMs);
     setState(State::IDLE, nowMs);
   }
 }
@@ -151,25 +212,68 @@ void AccessController::handleOpening(uint32_t nowMs) {
   // Verificar si la barrera terminó de abrir
   if (barrier_->isOpen()) {
     setState(State::WAIT_PASS, nowMs);
+    passArmed_ = pass_->isDetected();
     LOG_INFO("Barrier opened - waiting for vehicle to pass");
   }
 }
 
 void AccessController::handleWaitPass(uint32_t nowMs) {
-  // Verificar timeout para pasar
-  if (getStateTime(nowMs) > passTimeMs_) {
-    LOG_INFO("Pass timeout - closing barrier");
-    setState(State::CLOSING, nowMs);
-    barrier_->close();
-    return;
+  // Paso detectado: el sensor vio el vehículo y ya quedó libre
+  bool passed = false;
+  if (passDetection_) {
+    if (pass_->isDetected()) {
+      passArmed_ = true;
+    } else if (passArmed_) {
+      passed = true;
+    }
   }
   
-  // TODO: En versión futura, detectar paso del vehículo con sensor adicional
-  // Por ahora, esperar timeout completo
+  // kPassTimeMs queda como cota superior (vehículo que no pasa, sensor caído)
+  if (!passed && getStateTime(nowMs) <= passTimeMs_) return;
+  
+  Metrics::record(Metrics::Histogram::PASS_TIME, getStateTime(nowMs));
+  if (passed) {
+    stats_.passages++;
+    LOG_INFO("Vehicle passed after %lu ms", getStateTime(nowMs));
+  } else {
+    stats_.passTimeouts++;
+  }
+  
+  // Hay otro pedido atendible: dejar la barrera abierta
+  if (chainNext(nowMs)) return;
+  
+  if (passed) {
+    LOG_INFO("Passage complete - closing barrier");
+  } else {
+    LOG_INFO("Pass timeout - closing barrier");
+  }
+  setState(State::CLOSING, nowMs);
+  closeRetries_ = 0;
+  barrier_->close();
 }
 
 void AccessController::handleClosing(uint32_t nowMs) {
-  // El sensor de seguridad se maneja en Barrier.update()
+  // El sensor de seguridad se maneja en la tarea de movimiento de la
+  // barrera: si se activa durante el cierre, la barrera vuelve a abrir.
+  // Reabierta, esperar a que se libere (con cota) y reintentar el cierre
+  if (barrier_->isOpen() || barrier_->getState() == BarrierState::OPENING) {
+    if (safe_->isDetected() || !barrier_->isOpen()) {
+      if (getStateTime(nowMs) > Cfg::kSafetyHoldMs) {
+        handleTimeout("Safety sensor held", nowMs);
+      }
+      return;
+    }
+    if (closeRetries_ >= Cfg::kSafetyRetries) {
+      handleTimeout("Safety retries exhausted", nowMs);
+      return;
+    }
+    closeRetries_++;
+    LOG_INFO("Safety sensor clear - closing barrier again (retry %u/%u)",
+             (unsigned)closeRetries_, (unsigned)Cfg::kSafetyRetries);
+    stateStartMs_ = nowMs;   // El timeout de cierre cuenta desde el nuevo comando
+    barrier_->close();
+    return;
+  }
   
   // Verificar timeout
   if (getStateTime(nowMs) > closeTimeoutMs_) {
@@ -182,6 +286,11 @@ void AccessController::handleClosing(uint32_t nowMs) {
     LOG_INFO("Barrier closed - operation complete");
     setState(State::IDLE, nowMs);
     
+    uint32_t cycleMs = nowMs - cycleStartMs_;
+    stats_.cycles++;
+    stats_.totalCycleMs += cycleMs;
+    if (cycleMs > stats_.maxCycleMs) stats_.maxCycleMs = cycleMs;
+    
     // Limpiar contexto
     assignedSlot_ = -1;
     isExitOperation_ = false;
@@ -192,10 +301,9 @@ void AccessController::handleFault(uint32_t nowMs) {
   // En estado FAULT, solo esperar reset manual
   // Podríamos implementar auto-recovery después de cierto tiempo
   
-  static uint32_t lastFaultLog = 0;
-  if (nowMs - lastFaultLog > 10000) { // Log cada 10 segundos
+  if (nowMs - lastFaultLogMs_ > kFaultLogMs) { // Log cada 10 segundos
     LOG_WARN("System in FAULT state - manual reset required");
-    lastFaultLog = nowMs;
+    lastFaultLogMs_ = nowMs;
   }
 }
 
@@ -207,29 +315,106 @@ void AccessController::setState(State newState, uint32_t nowMs) {
     state_ = newState;
     stateStartMs_ = nowMs;
     
-    // Log cambios de estado
-    if (lastLoggedState_ != newState) {
-      LOG_INFO("AccessController: %s -> %s", 
-               oldState == State::IDLE ? "IDLE" :
-               oldState == State::CHECK_CAPACITY ? "CHECK_CAPACITY" :
-               oldState == State::OPENING ? "OPENING" :
-               oldState == State::WAIT_PASS ? "WAIT_PASS" :
-               oldState == State::CLOSING ? "CLOSING" : "FAULT",
-               getStateName());
-      lastLoggedState_ = newState;
+    Metrics::set(Metrics::Gauge::ACCESS_STATE, static_cast<uint32_t>(newState));
+    Metrics::set(Metrics::Gauge::QUEUE_DEPTH, queue_.size());
+    if (newState == State::WAIT_PASS) {
+      Metrics::record(Metrics::Histogram::OPEN_LATENCY, nowMs - requestMs_);
+    } else if (newState == State::FAULT) {
+      Metrics::add(Metrics::Counter::FAULTS);
+    } else if (oldState == State::CLOSING && newState == State::IDLE) {
+      Metrics::record(Metrics::Histogram::CYCLE, nowMs - cycleStartMs_);
     }
+    
+    AppBus::publish(Events::AccessStateChanged{oldState, newState, nowMs});
   }
 }
 
-void AccessController::requestEntry(VehicleClass vc, uint32_t nowMs) {
-  if (state_ != State::IDLE) {
-    LOG_WARN("Entry request ignored - system busy");
+void AccessController::pollButtons(uint32_t nowMs) {
+  if (btnVip_->wasPressed()) {
+    AppBus::publish(Events::ButtonPressed{VehicleClass::VIP, nowMs});
+    enqueue(false, VehicleClass::VIP, nowMs);
+  }
+  
+  if (btnCarga_->wasPressed()) {
+    AppBus::publish(Events::ButtonPressed{VehicleClass::CARGA, nowMs});
+    enqueue(false, VehicleClass::CARGA, nowMs);
+  }
+  
+  if (btnReg_->wasPressed()) {
+    AppBus::publish(Events::ButtonPressed{VehicleClass::REGULAR, nowMs});
+    enqueue(false, VehicleClass::REGULAR, nowMs);
+  }
+  
+  if (btnExit_->wasPressed()) {
+    AppBus::publish(Events::ExitButtonPressed{nowMs});
+    enqueue(true, VehicleClass::REGULAR, nowMs);
+  }
+}
+
+void AccessController::enqueue(bool exit, VehicleClass vc, uint32_t nowMs) {
+  if (state_ == State::FAULT) {
+    LOG_WARN("Request ignored - system in FAULT");
     return;
   }
   
+  switch (queue_.push(AccessRequest{exit, vc, nowMs})) {
+    case RequestQueue::PushResult::QUEUED:
+      Metrics::set(Metrics::Gauge::QUEUE_DEPTH, queue_.size());
+      if (state_ != State::IDLE) stats_.arrivedBusy++;
+      AppBus::publish(Events::RequestQueued{exit, vc, static_cast<uint8_t>(queue_.size()), nowMs});
+      break;
+    case RequestQueue::PushResult::MERGED:
+      break;
+    case RequestQueue::PushResult::FULL:
+      AppBus::publish(Events::RequestDropped{exit, vc, nowMs});
+      break;
+  }
+}
+
+bool AccessController::chainNext(uint32_t nowMs) {
+  // Tomar pedidos hasta encontrar uno atendible con la barrera abierta;
+  // las entradas sin capacidad se rechazan igual que en CHECK_CAPACITY
+  AccessRequest req;
+  while (queue_.pop(req, nowMs)) {
+    if (req.exit) {
+      isExitOperation_ = true;
+      assignedSlot_ = -1;
+      stats_.exits++;
+      Metrics::add(Metrics::Counter::EXITS);
+      LOG_INFO("Chaining exit request - barrier stays open");
+    } else {
+      Metrics::add(Metrics::entryOf(req.vehicleClass));
+      int slot = slots_->allocate(req.vehicleClass);
+      if (slot < 0) {
+        deny(req.vehicleClass, nowMs);
+        continue;
+      }
+      pendingClass_ = req.vehicleClass;
+      isExitOperation_ = false;
+      assignedSlot_ = slot;
+      stats_.entries++;
+      LOG_INFO("Chaining entry to slot %d - barrier stays open", slot);
+    }
+    
+    // Nuevo tiempo de paso sin salir de WAIT_PASS: la barrera ya está
+    // abierta para este pedido
+    Metrics::record(Metrics::Histogram::OPEN_LATENCY, nowMs - req.enqueuedMs);
+    Metrics::set(Metrics::Gauge::QUEUE_DEPTH, queue_.size());
+    requestMs_ = req.enqueuedMs;
+    stats_.chained++;
+    stateStartMs_ = nowMs;
+    passArmed_ = pass_->isDetected();
+    return true;
+  }
+  return false;
+}
+
+void AccessController::requestEntry(VehicleClass vc, uint32_t nowMs) {
+  cycleStartMs_ = nowMs;
   pendingClass_ = vc;
   isExitOperation_ = false;
   assignedSlot_ = -1;
+  Metrics::add(Metrics::entryOf(vc));
   
   setState(State::CHECK_CAPACITY, nowMs);
   
@@ -239,13 +424,10 @@ void AccessController::requestEntry(VehicleClass vc, uint32_t nowMs) {
 }
 
 void AccessController::requestExit(uint32_t nowMs) {
-  if (state_ != State::IDLE) {
-    LOG_WARN("Exit request ignored - system busy");
-    return;
-  }
-  
+  cycleStartMs_ = nowMs;
   isExitOperation_ = true;
   assignedSlot_ = -1;
+  Metrics::add(Metrics::Counter::EXITS);
   
   setState(State::CHECK_CAPACITY, nowMs); // Siempre permitir salida
   LOG_INFO("Exit request received");
@@ -254,8 +436,17 @@ void AccessController::requestExit(uint32_t nowMs) {
 void AccessController::handleTimeout(const char* reason, uint32_t nowMs) {
   LOG_ERR("AccessController timeout: %s (state: %s, time: %lu ms)", 
           reason, getStateName(), getStateTime(nowMs));
+  Metrics::add(state_ == State::OPENING ? Metrics::Counter::OPEN_TIMEOUTS
+                                        : Metrics::Counter::CLOSE_TIMEOUTS);
   
   // Intentar parar la barrera y ir a FAULT
+  AppBus::publish(Events::SystemFault{reason, nowMs});
   barrier_->stop();
   setState(State::FAULT, nowMs);
-}
\ No newline at end of file
+}
+
+void AccessController::deny(VehicleClass vc, uint32_t nowMs) {
+  stats_.denied++;
+  Metrics::add(Metrics::deniedOf(vc));
+  AppBus::publish(Events::CapacityFull{vc, nowMs});
+}
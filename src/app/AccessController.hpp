@@ -2,27 +2,42 @@
 #include "core/Types.hpp"
 #include "devices/Barrier.hpp"
 #include "app/SlotManager.hpp"
+#include "app/RequestQueue.hpp"
 #include "devices/Button.hpp"
 #include "devices/ProximitySensor.hpp"
 #include "core/Config.hpp"
 
+// FSM de la barrera. Las pulsaciones se encolan en cualquier estado
+// (RequestQueue); la FSM toma el siguiente pedido al quedar IDLE o, con la
+// barrera todavía abierta, al terminar WAIT_PASS (encadenado sin cerrar).
 class AccessController {
 public:
-  enum class State : uint8_t { 
-    IDLE, 
-    CHECK_CAPACITY, 
-    OPENING, 
-    WAIT_PASS, 
-    CLOSING, 
-    FAULT 
+  using State = AccessState;
+
+  // Contadores de throughput desde el arranque
+  struct Stats {
+    uint32_t entries{0};      // Entradas con slot asignado
+    uint32_t exits{0};
+    uint32_t chained{0};      // Atendidas sin cerrar/reabrir la barrera
+    uint32_t denied{0};       // Sin capacidad al desencolar
+    uint32_t arrivedBusy{0};  // Llegaron con la barrera ocupada
+    uint32_t passages{0};     // WAIT_PASS terminado por detección de paso
+    uint32_t passTimeouts{0}; // WAIT_PASS terminado por kPassTimeMs
+    uint32_t cycles{0};       // Pedido -> barrera cerrada
+    uint32_t maxCycleMs{0};
+    uint64_t totalCycleMs{0};
   };
 
-  void begin(Barrier* barrier, SlotManager* slots,
+  void begin(Barrier* barrier, ParkingSlots* slots,
              Button* btnVip, Button* btnCarga, Button* btnReg, Button* btnExit,
-             ProximitySensor* safe);
+             ProximitySensor* safe, ProximitySensor* pass = nullptr);
   
   void update(uint32_t nowMs);
   
+  // Milisegundos hasta que update() tenga algo que hacer sin nuevas entradas
+  // (timeouts, fin de movimiento, pulsación pendiente); kNoDeadline si nada
+  uint32_t msUntilNext(uint32_t nowMs) const;
+  
   // Estado actual
   State getState() const { return state_; }
   bool isIdle() const { return state_ == State::IDLE; }
@@ -32,11 +47,27 @@ public:
   void reset(); // Salir de FAULT y volver a IDLE
   void emergencyStop(); // Parar barrera inmediatamente
   
+  // Cierre anticipado al detectar el paso (sensor caído: desactivar)
+  void setPassDetection(bool enabled) { passDetection_ = enabled; }
+  
+  // Tiempo de paso y timeouts de la FSM (por defecto los de Cfg)
+  void setTiming(const Cfg::GateTiming& timing) {
+    passTimeMs_ = timing.passTimeMs;
+    openTimeoutMs_ = timing.openTimeoutMs;
+    closeTimeoutMs_ = timing.closeTimeoutMs;
+  }
+  
   // Para debugging
   const char* getStateName() const;
   VehicleClass getPendingClass() const { return pendingClass_; }
   int getAssignedSlot() const { return assignedSlot_; }
   uint32_t getStateTime(uint32_t nowMs) const { return nowMs - stateStartMs_; }
+  
+  // Cola de pedidos y throughput
+  const Stats& stats() const { return stats_; }
+  const RequestQueue& queue() const { return queue_; }
+  uint32_t vehiclesPerHour(uint32_t nowMs) const;
+  void printStats(uint32_t nowMs) const;
 
 private:
   // Handlers de estado
@@ -47,37 +78,53 @@ private:
   void handleClosing(uint32_t nowMs);
   void handleFault(uint32_t nowMs);
   
+  // Pedidos
+  void pollButtons(uint32_t nowMs);
+  void enqueue(bool exit, VehicleClass vc, uint32_t nowMs);
+  bool chainNext(uint32_t nowMs);
+
   // Transiciones
   void setState(State newState, uint32_t nowMs);
   void requestEntry(VehicleClass vc, uint32_t nowMs);
   void requestExit(uint32_t nowMs);
   void handleTimeout(const char* reason, uint32_t nowMs);
+  void deny(VehicleClass vc, uint32_t nowMs);
 
   // Referencias a hardware y lógica
   Barrier* barrier_{nullptr};
-  SlotManager* slots_{nullptr};
+  ParkingSlots* slots_{nullptr};
   Button* btnVip_{nullptr};
   Button* btnCarga_{nullptr};
   Button* btnReg_{nullptr};
   Button* btnExit_{nullptr};
   ProximitySensor* safe_{nullptr};
+  ProximitySensor* pass_{nullptr};   // Detección de paso (safe_ si no hay lazo)
   
   // Estado de la FSM
   State state_{State::IDLE};
-  State lastLoggedState_{State::IDLE};
   uint32_t stateStartMs_{0};
   
   // Contexto de la operación actual
   VehicleClass pendingClass_{VehicleClass::REGULAR};
   int assignedSlot_{-1};
   bool isExitOperation_{false};
+  bool passArmed_{false};            // El sensor de paso vio el vehículo
+  uint8_t closeRetries_{0};          // Cierres reintentados tras reabrir por seguridad
+  uint32_t cycleStartMs_{0};
+  uint32_t requestMs_{0};            // Pulsación del pedido en curso (latencia a abierta)
+  bool passDetection_{Cfg::kPassDetection};
+  
+  RequestQueue queue_;
+  Stats stats_;
   
   // Timeouts
-  const uint32_t passTimeMs_ = Cfg::kPassTimeMs;
-  const uint32_t openTimeoutMs_ = Cfg::kOpenTimeout;
-  const uint32_t closeTimeoutMs_ = Cfg::kCloseTimeout;
+  uint32_t passTimeMs_ = Cfg::kPassTimeMs;
+  uint32_t openTimeoutMs_ = Cfg::kOpenTimeout;
+  uint32_t closeTimeoutMs_ = Cfg::kCloseTimeout;
+  static constexpr uint32_t kFaultLogMs = 10000;
   
   // Para evitar spam de logs
   bool safeSensorLastState_{false};
+  uint32_t lastFaultLogMs_{0};
   bool initialized_{false};
 };
\ No newline at end of file
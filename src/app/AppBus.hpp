@@ -0,0 +1,32 @@
+#pragma once
+#include "core/Config.hpp"
+#include "core/EventBus.hpp"
+#include "app/Events.hpp"
+#include "app/EventLog.hpp"
+#include "app/TraceMarks.hpp"
+
+// Bus de eventos de la aplicación. Los módulos publican con
+// AppBus::publish(Events::X{...}); main.cpp llama a AppBus::dispatch()
+// al final de cada paso de control. Para agregar un consumidor (telemetría,
+// métricas), sumarlo a AppSubscribers con sus sobrecargas on(const Evento&).
+// EventLog va aparte, en el acto: sus líneas quedan en el orden en que se
+// publicaron los eventos, intercaladas con el resto del log del paso (el
+// log diferido de LogRing sólo copia al ring).
+using AppImmediateSubscribers = SubscriberList<EventLog>;
+using AppSubscribers = SubscriberList<TraceMarks>;
+
+using AppBus = EventBus<AppImmediateSubscribers, AppSubscribers, Cfg::kEventQueueLen,
+                        Events::ButtonPressed,
+                        Events::ExitButtonPressed,
+                        Events::RequestQueued,
+                        Events::RequestDropped,
+                        Events::BarrierOpened,
+                        Events::BarrierClosed,
+                        Events::BarrierTimeout,
+                        Events::SlotOccupied,
+                        Events::SlotFreed,
+                        Events::SafetySensorActivated,
+                        Events::SafetySensorDeactivated,
+                        Events::SystemFault,
+                        Events::CapacityFull,
+                        Events::AccessStateChanged>;
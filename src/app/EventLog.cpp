@@ -0,0 +1,82 @@
+#include "EventLog.hpp"
+#include "core/Logger.hpp"
+
+namespace {
+  const char* className(VehicleClass vc) {
+    return vc == VehicleClass::VIP ? "VIP" :
+           vc == VehicleClass::CARGA ? "CARGA" : "REGULAR";
+  }
+
+  const char* accessStateName(AccessState s) {
+    switch (s) {
+      case AccessState::IDLE: return "IDLE";
+      case AccessState::CHECK_CAPACITY: return "CHECK_CAPACITY";
+      case AccessState::OPENING: return "OPENING";
+      case AccessState::WAIT_PASS: return "WAIT_PASS";
+      case AccessState::CLOSING: return "CLOSING";
+      case AccessState::FAULT: return "FAULT";
+      default: return "UNKNOWN";
+    }
+  }
+}
+
+void EventLog::on(const Events::ButtonPressed& e) {
+  LOG_DEBUG("Button pressed: %s (t=%lu ms)", className(e.vehicleClass), (unsigned long)e.timestamp);
+}
+
+void EventLog::on(const Events::ExitButtonPressed& e) {
+  LOG_DEBUG("Exit button pressed (t=%lu ms)", (unsigned long)e.timestamp);
+}
+
+void EventLog::on(const Events::RequestQueued& e) {
+  LOG_INFO("%s request queued (depth %u)", e.exit ? "Exit" : className(e.vehicleClass),
+           (unsigned)e.depth);
+}
+
+void EventLog::on(const Events::RequestDropped& e) {
+  LOG_WARN("Request queue full - %s request dropped", e.exit ? "exit" : className(e.vehicleClass));
+}
+
+void EventLog::on(const Events::BarrierOpened&) {
+  LOG_INFO("Barrier opened");
+}
+
+void EventLog::on(const Events::BarrierClosed&) {
+  LOG_INFO("Barrier closed");
+}
+
+void EventLog::on(const Events::BarrierTimeout& e) {
+  LOG_ERR("Barrier %s timeout", e.state == BarrierState::OPENING ? "open" : "close");
+}
+
+void EventLog::on(const Events::SlotOccupied& e) {
+  LOG_INFO("Slot %d (%s) OCCUPIED", e.slotIndex, e.slotName);
+}
+
+void EventLog::on(const Events::SlotFreed& e) {
+  LOG_INFO("Slot %d (%s) FREED", e.slotIndex, e.slotName);
+}
+
+void EventLog::on(const Events::SafetySensorActivated&) {
+  LOG_INFO("Safety sensor: ACTIVE");
+}
+
+void EventLog::on(const Events::SafetySensorDeactivated&) {
+  LOG_INFO("Safety sensor: INACTIVE");
+}
+
+void EventLog::on(const Events::SystemFault& e) {
+  LOG_ERR("System fault: %s", e.description);
+}
+
+void EventLog::on(const Events::CapacityFull& e) {
+  LOG_WARN("Access denied for %s - no available slots", className(e.deniedClass));
+}
+
+void EventLog::on(const Events::AccessStateChanged& e) {
+  LOG_INFO("AccessController: %s -> %s", accessStateName(e.from), accessStateName(e.to));
+}
+
+void EventLog::onDropped(uint32_t count) {
+  LOG_WARN("Event queue full - %lu events dropped", (unsigned long)count);
+}
@@ -0,0 +1,24 @@
+#pragma once
+#include "app/Events.hpp"
+
+// Suscriptor del bus que traduce eventos a líneas de log.
+// Se ejecuta en AppBus::publish(), en el orden de publicación y junto al
+// log de quien publica (ver app/AppBus.hpp).
+class EventLog {
+public:
+  static void on(const Events::ButtonPressed& e);
+  static void on(const Events::ExitButtonPressed& e);
+  static void on(const Events::RequestQueued& e);
+  static void on(const Events::RequestDropped& e);
+  static void on(const Events::BarrierOpened& e);
+  static void on(const Events::BarrierClosed& e);
+  static void on(const Events::BarrierTimeout& e);
+  static void on(const Events::SlotOccupied& e);
+  static void on(const Events::SlotFreed& e);
+  static void on(const Events::SafetySensorActivated& e);
+  static void on(const Events::SafetySensorDeactivated& e);
+  static void on(const Events::SystemFault& e);
+  static void on(const Events::CapacityFull& e);
+  static void on(const Events::AccessStateChanged& e);
+  static void onDropped(uint32_t count);
+};
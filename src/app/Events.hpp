@@ -14,6 +14,21 @@ namespace Events {
     uint32_t timestamp;
   };
   
+  // Pedido encolado delante de la FSM (depth = pedidos en cola tras encolar)
+  struct RequestQueued {
+    bool exit;
+    VehicleClass vehicleClass;
+    uint8_t depth;
+    uint32_t timestamp;
+  };
+  
+  // Pedido descartado: cola llena
+  struct RequestDropped {
+    bool exit;
+    VehicleClass vehicleClass;
+    uint32_t timestamp;
+  };
+  
   // Eventos de barrera
   struct BarrierOpened {
     uint32_t timestamp;
@@ -32,12 +47,14 @@ namespace Events {
   struct SlotOccupied {
     int slotIndex;
     SlotType slotType;
+    const char* slotName;   // Del layout constexpr: vive todo el programa
     uint32_t timestamp;
   };
   
   struct SlotFreed {
     int slotIndex;
     SlotType slotType;
+    const char* slotName;   // Del layout constexpr: vive todo el programa
     uint32_t timestamp;
   };
   
@@ -60,4 +77,11 @@ namespace Events {
     VehicleClass deniedClass;
     uint32_t timestamp;
   };
+  
+  // Transición de la FSM de acceso
+  struct AccessStateChanged {
+    AccessState from;
+    AccessState to;
+    uint32_t timestamp;
+  };
 }
\ No newline at end of file
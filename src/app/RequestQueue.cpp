@@ -0,0 +1,67 @@
+#include "RequestQueue.hpp"
+
+RequestQueue::PushResult RequestQueue::push(const AccessRequest& req) {
+  // Mismo pedido todavía en cola y reciente: el conductor volvió a pulsar
+  for (size_t i = 0; i < count_; i++) {
+    const auto& q = items_[i];
+    if (q.exit == req.exit && (req.exit || q.vehicleClass == req.vehicleClass) &&
+        req.enqueuedMs - q.enqueuedMs < Cfg::kRequestMergeMs) {
+      stats_.merged++;
+      return PushResult::MERGED;
+    }
+  }
+
+  if (count_ >= items_.size()) {
+    stats_.dropped++;
+    return PushResult::FULL;
+  }
+
+  items_[count_++] = req;
+  stats_.enqueued++;
+  if (count_ > stats_.maxDepth) stats_.maxDepth = count_;
+  return PushResult::QUEUED;
+}
+
+bool RequestQueue::pop(AccessRequest& out, uint32_t nowMs) {
+  if (count_ == 0) return false;
+
+  size_t best = 0;
+  uint32_t bestPrio = priority(items_[0], nowMs);
+  for (size_t i = 1; i < count_; i++) {
+    uint32_t prio = priority(items_[i], nowMs);
+    if (prio > bestPrio ||
+        (prio == bestPrio && nowMs - items_[i].enqueuedMs > nowMs - items_[best].enqueuedMs)) {
+      best = i;
+      bestPrio = prio;
+    }
+  }
+
+  out = items_[best];
+  items_[best] = items_[--count_];   // Sin orden: el último ocupa el hueco
+
+  uint32_t waitMs = nowMs - out.enqueuedMs;
+  stats_.dequeued++;
+  stats_.totalWaitMs += waitMs;
+  if (waitMs > stats_.maxWaitMs) stats_.maxWaitMs = waitMs;
+  return true;
+}
+
+size_t RequestQueue::clear() {
+  size_t discarded = count_;
+  count_ = 0;
+  return discarded;
+}
+
+uint32_t RequestQueue::priority(const AccessRequest& req, uint32_t nowMs) {
+  uint32_t base;
+  if (req.exit) {
+    base = 2;   // Una salida libera capacidad para los que esperan entrar
+  } else {
+    switch (req.vehicleClass) {
+      case VehicleClass::VIP: base = 2; break;
+      case VehicleClass::CARGA: base = 1; break;
+      default: base = 0; break;
+    }
+  }
+  return base + (nowMs - req.enqueuedMs) / Cfg::kRequestAgingMs;
+}
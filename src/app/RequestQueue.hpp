@@ -0,0 +1,49 @@
+#pragma once
+#include <array>
+#include "core/Types.hpp"
+#include "core/Config.hpp"
+
+// Pedido de entrada o salida esperando la barrera
+struct AccessRequest {
+  bool exit;
+  VehicleClass vehicleClass;   // Sólo significativo en entradas
+  uint32_t enqueuedMs;
+};
+
+// Cola acotada de pedidos delante de la FSM de acceso.
+// pop() entrega el de mayor prioridad efectiva: prioridad base por tipo
+// (salida y VIP > CARGA > REGULAR) más un nivel por cada Cfg::kRequestAgingMs
+// de espera, para que un REGULAR no quede postergado indefinidamente.
+// Empates: el más antiguo. Capacidad chica: búsqueda lineal, sin orden.
+class RequestQueue {
+public:
+  enum class PushResult : uint8_t { QUEUED, MERGED, FULL };
+
+  struct Stats {
+    uint32_t enqueued{0};
+    uint32_t merged{0};    // Pulsación repetida del mismo pedido
+    uint32_t dropped{0};   // Cola llena
+    uint32_t dequeued{0};
+    uint32_t maxDepth{0};
+    uint32_t maxWaitMs{0};
+    uint64_t totalWaitMs{0};
+  };
+
+  PushResult push(const AccessRequest& req);
+  bool pop(AccessRequest& out, uint32_t nowMs);
+  size_t clear();   // Retorna los pedidos descartados
+
+  bool empty() const { return count_ == 0; }
+  size_t size() const { return count_; }
+  const Stats& stats() const { return stats_; }
+  uint32_t avgWaitMs() const {
+    return stats_.dequeued ? static_cast<uint32_t>(stats_.totalWaitMs / stats_.dequeued) : 0;
+  }
+
+  static uint32_t priority(const AccessRequest& req, uint32_t nowMs);
+
+private:
+  std::array<AccessRequest, Cfg::kRequestQueueLen> items_{};
+  size_t count_{0};
+  Stats stats_;
+};
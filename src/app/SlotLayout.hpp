@@ -0,0 +1,61 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <iterator>
+#include "core/Types.hpp"
+#include "core/Pins.hpp"
+
+// Descripción de un slot del estacionamiento. Un layout es un tipo con
+// una tabla constexpr 'kSlots' (arreglo o std::array, id == índice en la
+// tabla); SlotManager<Layout> toma de ahí la cantidad, los tipos, los
+// niveles y los pines en compilación. Una tabla grande puede generarse con
+// una función constexpr en lugar de escribirse a mano.
+struct SlotSpec {
+  uint16_t id;
+  SlotType type;
+  uint8_t level;        // Piso / nivel (0 = planta baja)
+  uint16_t gateDist;    // Recorrido desde la barrera en metros (NEAREST_GATE)
+  uint8_t sensorPin;    // Sensor de presencia PNP con pullup
+  Pins::TL light;       // Semáforo rojo/verde del slot
+  const char* name;
+};
+
+// Cantidad de slots y de niveles (el mayor 'level' + 1) de un layout
+template <typename Layout>
+constexpr size_t slotLayoutSize() {
+  return std::size(Layout::kSlots);
+}
+
+template <typename Layout>
+constexpr size_t slotLayoutLevels() {
+  size_t levels = 0;
+  for (const auto& spec : Layout::kSlots) {
+    if (spec.level + 1u > levels) levels = spec.level + 1u;
+  }
+  return levels;
+}
+
+// Validación en compilación: ids = índices y tipos en rango
+template <typename Layout>
+constexpr bool slotLayoutValid() {
+  size_t i = 0;
+  for (const auto& spec : Layout::kSlots) {
+    if (spec.id != i++ || spec.type > SlotType::REGULAR) return false;
+  }
+  return true;
+}
+
+// MVP: 6 slots en un nivel. 0,1: VIP | 2,3: CARGA | 4,5: REGULAR
+struct MvpLayout {
+  static constexpr SlotSpec kSlots[] = {
+    {0, SlotType::VIP,     0,  4, Pins::S_VIP1,  Pins::TL_VIP1,  "VIP1"},
+    {1, SlotType::VIP,     0,  7, Pins::S_VIP2,  Pins::TL_VIP2,  "VIP2"},
+    {2, SlotType::CARGA,   0, 12, Pins::S_CARG1, Pins::TL_CARG1, "CARGA1"},
+    {3, SlotType::CARGA,   0, 16, Pins::S_CARG2, Pins::TL_CARG2, "CARGA2"},
+    {4, SlotType::REGULAR, 0, 21, Pins::S_REG1,  Pins::TL_REG1,  "REG1"},
+    {5, SlotType::REGULAR, 0, 24, Pins::S_REG2,  Pins::TL_REG2,  "REG2"},
+  };
+};
+
+// Layout del firmware (app/SlotManager.cpp instancia SlotManager<ParkingLayout>)
+using ParkingLayout = MvpLayout;
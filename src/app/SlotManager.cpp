@@ -1,231 +1,281 @@
 #include "SlotManager.hpp"
 #include "core/Logger.hpp"
-#include "core/Pins.hpp"
-
-void SlotManager::begin() {
-  // Configurar los 6 slots según el layout:
-  // 0,1: VIP | 2,3: CARGA | 4,5: REGULAR
-  
-  slots_[0] = {SlotType::VIP, SlotState::FREE, {}, {}, 0, "VIP1"};
-  slots_[1] = {SlotType::VIP, SlotState::FREE, {}, {}, 1, "VIP2"};
-  slots_[2] = {SlotType::CARGA, SlotState::FREE, {}, {}, 2, "CARGA1"};
-  slots_[3] = {SlotType::CARGA, SlotState::FREE, {}, {}, 3, "CARGA2"};
-  slots_[4] = {SlotType::REGULAR, SlotState::FREE, {}, {}, 4, "REG1"};
-  slots_[5] = {SlotType::REGULAR, SlotState::FREE, {}, {}, 5, "REG2"};
-
-  // Configurar sensores y semáforos
-  slots_[0].sensor.begin(Pins::S_VIP1, true, true);      // PNP, pullup
-  slots_[0].trafficLight.begin(Pins::TL_VIP1.RED, Pins::TL_VIP1.GREEN);
-  
-  slots_[1].sensor.begin(Pins::S_VIP2, true, true);
-  slots_[1].trafficLight.begin(Pins::TL_VIP2.RED, Pins::TL_VIP2.GREEN);
-  
-  slots_[2].sensor.begin(Pins::S_CARG1, true, true);
-  slots_[2].trafficLight.begin(Pins::TL_CARG1.RED, Pins::TL_CARG1.GREEN);
-  
-  slots_[3].sensor.begin(Pins::S_CARG2, true, true);
-  slots_[3].trafficLight.begin(Pins::TL_CARG2.RED, Pins::TL_CARG2.GREEN);
-  
-  slots_[4].sensor.begin(Pins::S_REG1, true, true);
-  slots_[4].trafficLight.begin(Pins::TL_REG1.RED, Pins::TL_REG1.GREEN);
-  
-  slots_[5].sensor.begin(Pins::S_REG2, true, true);
-  slots_[5].trafficLight.begin(Pins::TL_REG2.RED, Pins::TL_REG2.GREEN);
+#include "app/AppBus.hpp"
 
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::begin() {
+  // Estado inicial: todos libres
+  state_.fill(SlotState::FREE);
+  reservedAtMs_.fill(0);
+  freeMask_.reset();
+  pick_.reset();
+  freeTotal_ = reservedTotal_ = occupiedTotal_ = 0;
+  freeByType_.fill(0);
+  freeByLevel_.fill(0);
+
+  // Configurar sensores y semáforos según la tabla del layout
+  for (size_t i = 0; i < kSlots; i++) {
+    freeMask_.set(i);
+    adjustCounters(i, SlotState::FREE, +1);
+    sensors_[i].begin(spec(i).sensorPin, true, true);      // PNP, pullup
+    lights_[i].begin(spec(i).light.RED, spec(i).light.GREEN);
+  }
+
+  version_ = 0;
+  publishStatus();
   initialized_ = true;
-  
-  LOG_INFO("SlotManager initialized with %d slots", kSlots);
+
+  LOG_INFO("SlotManager initialized with %u slots on %u levels", (unsigned)kSlots, (unsigned)kLevels);
   printStatus();
 }
 
-void SlotManager::update(uint32_t nowMs) {
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::update(uint32_t nowMs) {
   if (!initialized_) return;
 
   // Actualizar estado de todos los slots basado en sensores
-  for (int i = 0; i < kSlots; i++) {
+  for (size_t i = 0; i < kSlots; i++) {
     updateSlotState(i, nowMs);
   }
 }
 
-int SlotManager::allocate(VehicleClass vc) {
+template <typename Layout, template <typename> class Pick, typename Fallback>
+int SlotManager<Layout, Pick, Fallback>::allocate(VehicleClass vc) {
   if (!initialized_) {
     LOG_ERR("SlotManager not initialized");
     return -1;
   }
 
-  // Estrategia FASE 1 + FASE 2:
-  // 1. Intentar slot de su misma clase
-  int slot = findSameClass(vc);
-  if (slot >= 0) {
-    LOG_INFO("Allocated slot %d (%s) for %s vehicle", 
-             slot, slots_[slot].name, 
-             vc == VehicleClass::VIP ? "VIP" : 
-             vc == VehicleClass::CARGA ? "CARGA" : "REGULAR");
-    return slot;
-  }
+  // Tipos a probar en orden: el propio y luego los de fallback
+  const FallbackGraph& graph = Fallback::kGraph;
+  size_t row = static_cast<size_t>(vc);
+  for (uint8_t k = 0; k < graph.count[row]; k++) {
+    int slot = findFree(graph.order[row][k]);
+    if (slot < 0) continue;
 
-  // 2. Si es VIP y no hay espacios VIP, buscar fallback
-  if (vc == VehicleClass::VIP) {
-    slot = findVipFallback();
-    if (slot >= 0) {
-      LOG_INFO("VIP fallback: allocated slot %d (%s) for VIP vehicle", 
-               slot, slots_[slot].name);
-      return slot;
+    reserve(slot);
+    if (k == 0) {
+      LOG_INFO("Allocated slot %d (%s) for %s vehicle",
+               slot, spec(slot).name,
+               vc == VehicleClass::VIP ? "VIP" :
+               vc == VehicleClass::CARGA ? "CARGA" : "REGULAR");
+    } else {
+      LOG_INFO("Fallback: allocated slot %d (%s) for %s vehicle",
+               slot, spec(slot).name,
+               vc == VehicleClass::VIP ? "VIP" :
+               vc == VehicleClass::CARGA ? "CARGA" : "REGULAR");
     }
+    return slot;
   }
 
-  // 3. No hay espacios disponibles
-  LOG_WARN("No available slots for %s vehicle", 
-           vc == VehicleClass::VIP ? "VIP" : 
+  // No hay espacios disponibles
+  LOG_WARN("No available slots for %s vehicle",
+           vc == VehicleClass::VIP ? "VIP" :
            vc == VehicleClass::CARGA ? "CARGA" : "REGULAR");
   return -1;
 }
 
-void SlotManager::releaseByIndex(int idx) {
-  if (idx < 0 || idx >= kSlots) {
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::releaseByIndex(int idx) {
+  if (idx < 0 || static_cast<size_t>(idx) >= kSlots) {
     LOG_ERR("Invalid slot index: %d", idx);
     return;
   }
 
-  if (slots_[idx].state == SlotState::OCCUPIED) {
-    slots_[idx].state = SlotState::FREE;
-    slots_[idx].trafficLight.setFree();
-    LOG_INFO("Manually released slot %d (%s)", idx, slots_[idx].name);
+  if (state_[idx] != SlotState::FREE) {
+    setSlotState(idx, SlotState::FREE);
+    lights_[idx].setFree();
+    LOG_INFO("Manually released slot %d (%s)", idx, spec(idx).name);
   }
 }
 
-void SlotManager::releaseAll() {
-  for (int i = 0; i < kSlots; i++) {
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::releaseAll() {
+  for (size_t i = 0; i < kSlots; i++) {
     releaseByIndex(i);
   }
   LOG_INFO("All slots manually released");
 }
 
-bool SlotManager::allFull() const {
-  return totalFreeCount() == 0;
+template <typename Layout, template <typename> class Pick, typename Fallback>
+bool SlotManager<Layout, Pick, Fallback>::allFull() const {
+  return freeTotal_ == 0;
 }
 
-size_t SlotManager::freeCount(SlotType t) const {
-  size_t count = 0;
-  for (const auto& slot : slots_) {
-    if (slot.type == t && slot.state == SlotState::FREE) {
-      count++;
-    }
-  }
-  return count;
+template <typename Layout, template <typename> class Pick, typename Fallback>
+size_t SlotManager<Layout, Pick, Fallback>::freeCount(SlotType t) const {
+  return freeByType_[static_cast<size_t>(t)];
 }
 
-size_t SlotManager::occupiedCount(SlotType t) const {
-  return kSlotsPerType - freeCount(t);
+template <typename Layout, template <typename> class Pick, typename Fallback>
+size_t SlotManager<Layout, Pick, Fallback>::occupiedCount(SlotType t) const {
+  return slotsOfType(t) - freeCount(t);
 }
 
-size_t SlotManager::totalFreeCount() const {
-  size_t count = 0;
-  for (const auto& slot : slots_) {
-    if (slot.state == SlotState::FREE) {
-      count++;
-    }
-  }
-  return count;
+template <typename Layout, template <typename> class Pick, typename Fallback>
+size_t SlotManager<Layout, Pick, Fallback>::freeCountOnLevel(uint8_t level) const {
+  if (level >= kLevels) return 0;
+  return freeByLevel_[level];
+}
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+size_t SlotManager<Layout, Pick, Fallback>::totalFreeCount() const {
+  return freeTotal_;
 }
 
-size_t SlotManager::totalOccupiedCount() const {
+template <typename Layout, template <typename> class Pick, typename Fallback>
+size_t SlotManager<Layout, Pick, Fallback>::totalOccupiedCount() const {
   return kSlots - totalFreeCount();
 }
 
-SlotState SlotManager::getSlotState(int idx) const {
-  if (idx < 0 || idx >= kSlots) return SlotState::FREE;
-  return slots_[idx].state;
+template <typename Layout, template <typename> class Pick, typename Fallback>
+SlotState SlotManager<Layout, Pick, Fallback>::getSlotState(int idx) const {
+  if (idx < 0 || static_cast<size_t>(idx) >= kSlots) return SlotState::FREE;
+  return state_[idx];
 }
 
-SlotType SlotManager::getSlotType(int idx) const {
-  if (idx < 0 || idx >= kSlots) return SlotType::REGULAR;
-  return slots_[idx].type;
+template <typename Layout, template <typename> class Pick, typename Fallback>
+SlotType SlotManager<Layout, Pick, Fallback>::getSlotType(int idx) const {
+  if (idx < 0 || static_cast<size_t>(idx) >= kSlots) return SlotType::REGULAR;
+  return spec(idx).type;
 }
 
-const char* SlotManager::getSlotName(int idx) const {
-  if (idx < 0 || idx >= kSlots) return "INVALID";
-  return slots_[idx].name;
+template <typename Layout, template <typename> class Pick, typename Fallback>
+uint8_t SlotManager<Layout, Pick, Fallback>::getSlotLevel(int idx) const {
+  if (idx < 0 || static_cast<size_t>(idx) >= kSlots) return 0;
+  return spec(idx).level;
 }
 
-void SlotManager::printStatus() const {
-  LOG_INFO("=== SLOT STATUS ===");
-  for (int i = 0; i < kSlots; i++) {
-    const auto& slot = slots_[i];
-    LOG_INFO("Slot %d (%s): %s %s", 
-             i, slot.name,
-             slot.type == SlotType::VIP ? "VIP" :
-             slot.type == SlotType::CARGA ? "CARGA" : "REG",
-             slot.state == SlotState::FREE ? "FREE" : "OCCUPIED");
-  }
-  LOG_INFO("Total: %d/%d occupied", totalOccupiedCount(), kSlots);
+template <typename Layout, template <typename> class Pick, typename Fallback>
+const char* SlotManager<Layout, Pick, Fallback>::getSlotName(int idx) const {
+  if (idx < 0 || static_cast<size_t>(idx) >= kSlots) return "INVALID";
+  return spec(idx).name;
 }
 
-// Private methods
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::printStatus() const {
+  Status st = status();
+  LOG_INFO("=== SLOT STATUS ===");
 
-int SlotManager::findSameClass(VehicleClass vc) const {
-  SlotType targetType = vehicleClassToSlotType(vc);
-  
-  for (int i = 0; i < kSlots; i++) {
-    if (slots_[i].type == targetType && slots_[i].state == SlotState::FREE) {
-      return i;
+  // Detalle por slot sólo en layouts chicos; en los grandes, por tipo y nivel
+  if (kSlots <= 16) {
+    for (size_t i = 0; i < kSlots; i++) {
+      LOG_INFO("Slot %u (%s): %s %s",
+               (unsigned)i, spec(i).name,
+               spec(i).type == SlotType::VIP ? "VIP" :
+               spec(i).type == SlotType::CARGA ? "CARGA" : "REG",
+               state_[i] == SlotState::FREE ? "FREE" :
+               state_[i] == SlotState::RESERVED ? "RESERVED" : "OCCUPIED");
     }
-  }
-  
-  return -1; // No encontrado
-}
-
-int SlotManager::findVipFallback() const {
-  // Política: VIP puede usar CARGA primero, luego REGULAR
-  if (Cfg::kVipFallback == Cfg::VipFallbackPolicy::CARGA_THEN_REGULAR) {
-    // Buscar CARGA libre
-    int slot = findSameClass(VehicleClass::CARGA);
-    if (slot >= 0) return slot;
-    
-    // Buscar REGULAR libre
-    return findSameClass(VehicleClass::REGULAR);
   } else {
-    // REGULAR_THEN_CARGA
-    int slot = findSameClass(VehicleClass::REGULAR);
-    if (slot >= 0) return slot;
-    
-    return findSameClass(VehicleClass::CARGA);
+    LOG_INFO("Free by type: VIP %u/%u, CARGA %u/%u, REG %u/%u",
+             (unsigned)st.freeByType[0], (unsigned)slotsOfType(SlotType::VIP),
+             (unsigned)st.freeByType[1], (unsigned)slotsOfType(SlotType::CARGA),
+             (unsigned)st.freeByType[2], (unsigned)slotsOfType(SlotType::REGULAR));
+    for (size_t level = 0; level < kLevels; level++) {
+      LOG_INFO("Level %u: %u/%u free", (unsigned)level, (unsigned)st.freeByLevel[level],
+               (unsigned)kLevelMask[level].count());
+    }
   }
+  LOG_INFO("Total: %u/%u occupied (%u reserved), status v%lu",
+           (unsigned)(kSlots - st.free), (unsigned)kSlots, (unsigned)st.reserved,
+           (unsigned long)st.version);
 }
 
-SlotType SlotManager::vehicleClassToSlotType(VehicleClass vc) const {
-  switch (vc) {
-    case VehicleClass::VIP: return SlotType::VIP;
-    case VehicleClass::CARGA: return SlotType::CARGA;
-    case VehicleClass::REGULAR: return SlotType::REGULAR;
-    default: return SlotType::REGULAR;
-  }
+// Private methods
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+int SlotManager<Layout, Pick, Fallback>::findFree(SlotType t) const {
+  return pick_.pick(t, kTypeMask[static_cast<size_t>(t)], freeMask_);
 }
 
-void SlotManager::updateSlotState(int idx, uint32_t nowMs) {
-  auto& slot = slots_[idx];
-  bool detected = slot.sensor.isDetected(nowMs);
-  
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::updateSlotState(int idx, uint32_t nowMs) {
+  SlotState state = state_[idx];
+  bool detected = sensors_[idx].isDetected();
+
   // Detectar cambios de estado
-  if (detected && slot.state == SlotState::FREE) {
+  if (detected && state != SlotState::OCCUPIED) {
     onSlotOccupied(idx);
-  } else if (!detected && slot.state == SlotState::OCCUPIED) {
+  } else if (!detected && state == SlotState::OCCUPIED) {
     onSlotFreed(idx);
+  } else if (!detected && state == SlotState::RESERVED &&
+             nowMs - reservedAtMs_[idx] > Cfg::kSlotReserveMs) {
+    // El vehículo asignado nunca llegó (se fue o estacionó en otro lado)
+    setSlotState(idx, SlotState::FREE);
+    LOG_WARN("Reservation expired for slot %d (%s)", idx, spec(idx).name);
+  }
+}
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::setSlotState(int idx, SlotState state) {
+  // Único lugar que cambia state_: mantiene freeMask_, la política, los
+  // contadores y la foto publicada al día
+  SlotState prev = state_[idx];
+  if (prev == state) return;
+  bool isFree = state == SlotState::FREE;
+  state_[idx] = state;
+  freeMask_.assign(idx, isFree);
+  if (isFree) {
+    pick_.onFree(idx);
+  } else if (prev == SlotState::FREE) {
+    pick_.onTaken(idx);
   }
+
+  adjustCounters(idx, prev, -1);
+  adjustCounters(idx, state, +1);
+  version_++;
+  publishStatus();
 }
 
-void SlotManager::onSlotOccupied(int idx) {
-  auto& slot = slots_[idx];
-  slot.state = SlotState::OCCUPIED;
-  slot.trafficLight.setOccupied();
-  
-  LOG_INFO("Slot %d (%s) OCCUPIED", idx, slot.name);
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::adjustCounters(int idx, SlotState state, int delta) {
+  switch (state) {
+    case SlotState::FREE:
+      freeTotal_ += delta;
+      freeByType_[static_cast<size_t>(spec(idx).type)] += delta;
+      freeByLevel_[spec(idx).level] += delta;
+      break;
+    case SlotState::RESERVED: reservedTotal_ += delta; break;
+    case SlotState::OCCUPIED: occupiedTotal_ += delta; break;
+  }
+}
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::publishStatus() {
+  Status st{};
+  st.version = version_;
+  st.updatedMs = millis();
+  st.free = freeTotal_;
+  st.reserved = reservedTotal_;
+  st.occupied = occupiedTotal_;
+  for (size_t t = 0; t < kSlotTypes; t++) st.freeByType[t] = freeByType_[t];
+  for (size_t l = 0; l < kLevels; l++) st.freeByLevel[l] = freeByLevel_[l];
+  status_.write(st);
+}
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::reserve(int idx) {
+  // El semáforo sigue en verde: guía al vehículo asignado
+  setSlotState(idx, SlotState::RESERVED);
+  reservedAtMs_[idx] = millis();
+}
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::onSlotOccupied(int idx) {
+  setSlotState(idx, SlotState::OCCUPIED);
+  lights_[idx].setOccupied();
+
+  AppBus::publish(Events::SlotOccupied{idx, spec(idx).type, spec(idx).name, millis()});
+}
+
+template <typename Layout, template <typename> class Pick, typename Fallback>
+void SlotManager<Layout, Pick, Fallback>::onSlotFreed(int idx) {
+  setSlotState(idx, SlotState::FREE);
+  lights_[idx].setFree();
+
+  AppBus::publish(Events::SlotFreed{idx, spec(idx).type, spec(idx).name, millis()});
 }
 
-void SlotManager::onSlotFreed(int idx) {
-  auto& slot = slots_[idx];
-  slot.state = SlotState::FREE;
-  slot.trafficLight.setFree();
-  
-  LOG_INFO("Slot %d (%s) FREED", idx, slot.name);
-}
\ No newline at end of file
+// Layout del firmware; otro layout necesita su propia instanciación acá
+template class SlotManager<ParkingLayout>;
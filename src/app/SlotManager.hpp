@@ -1,31 +1,63 @@
 #pragma once
 #include <array>
 #include "core/Types.hpp"
+#include "core/Bitmap.hpp"
+#include "core/SeqLock.hpp"
+#include "app/SlotLayout.hpp"
+#include "app/SlotPolicy.hpp"
 #include "devices/TrafficLight.hpp"
 #include "devices/ProximitySensor.hpp"
 #include "core/Config.hpp"
 
-struct Slot {
-  SlotType type;
-  SlotState state;
-  ProximitySensor sensor;
-  TrafficLight trafficLight;
-  
-  // Para debugging
-  uint8_t id;
-  const char* name;
-};
-
+// Slots del estacionamiento según un layout constexpr (app/SlotLayout.hpp).
+//
+// Datos por columnas: el estado que se lee en cada paso (state_ y los
+// mapas de bits) va junto y separado de la configuración fría de cada slot
+// (sensors_, lights_). Tipo, nivel, nombre y pines no se copian: se leen
+// de la tabla del layout, que queda en flash.
+//
+// Índice de ocupación: un mapa de bits por tipo y por nivel (armados en
+// compilación) y uno de slots FREE, mantenido en cada cambio de estado
+// (setSlotState) junto con contadores por tipo, por nivel y totales.
+// Buscar un slot es ctz sobre (tipo & libres) y los conteos se leen de los
+// contadores; nada recorre los slots salvo update() y printStatus().
+//
+// Cada cambio publica además un Status inmutable y versionado detrás de un
+// SeqLock: status() lo copia desde cualquier tarea o núcleo sin locks y a
+// costo fijo, sin importar cuántos slots haya ni cuán seguido se consulte.
+// El resto de la API es de la tarea de control.
+//
+// Qué tipos probar y qué slot libre elegir lo deciden Fallback y Pick
+// (app/SlotPolicy.hpp); por defecto, los que indica Cfg.
+template <typename Layout,
+          template <typename> class Pick = ParkingPick,
+          typename Fallback = ParkingFallback>
 class SlotManager {
 public:
-  static constexpr size_t kSlots = 6;
-  static constexpr size_t kSlotsPerType = 2;
+  static constexpr size_t kSlots = slotLayoutSize<Layout>();
+  static constexpr size_t kLevels = slotLayoutLevels<Layout>();
+  static constexpr size_t kSlotTypes = 3;
+  using SlotMask = Bitmap<kSlots>;
+  static_assert(kSlots <= 65535, "Slot counters are 16-bit");
+
+  // Foto de ocupación publicada en cada cambio de estado
+  struct Status {
+    uint32_t version;                          // Cambios de estado desde begin()
+    uint32_t updatedMs;
+    uint16_t free;
+    uint16_t reserved;
+    uint16_t occupied;
+    uint16_t freeByType[kSlotTypes];
+    uint16_t freeByLevel[kLevels];
+  };
 
   void begin();
   void update(uint32_t nowMs);
 
-  // Asignación según reglas FASE 1/2
-  int allocate(VehicleClass vc);   // Retorna índice de slot o -1 si no hay
+  // Asignación: los tipos de Fallback para la clase, en orden, y dentro de
+  // cada tipo el slot que elija Pick. Retorna índice de slot o -1 si no hay.
+  // Queda RESERVED hasta que su sensor lo ocupe o pase Cfg::kSlotReserveMs
+  int allocate(VehicleClass vc);
   void releaseByIndex(int idx);    // Para liberar en salida manual
   void releaseAll();               // Para resetear sistema
 
@@ -33,26 +65,76 @@ public:
   bool allFull() const;
   size_t freeCount(SlotType t) const;
   size_t occupiedCount(SlotType t) const;
+  size_t freeCountOnLevel(uint8_t level) const;
   size_t totalFreeCount() const;
   size_t totalOccupiedCount() const;
 
-  // Debug y monitoreo  
+  // Copia consistente de la última foto; cualquier tarea o núcleo
+  Status status() const { return status_.read(); }
+
+  // Slots de cada tipo en el layout
+  static constexpr size_t slotsOfType(SlotType t) { return kTypeMask[static_cast<size_t>(t)].count(); }
+
+  // Debug y monitoreo
   SlotState getSlotState(int idx) const;
   SlotType getSlotType(int idx) const;
+  uint8_t getSlotLevel(int idx) const;
   const char* getSlotName(int idx) const;
   void printStatus() const;
 
 private:
-  // Algoritmos de búsqueda
-  int findSameClass(VehicleClass vc) const;
-  int findVipFallback() const; // VIP → CARGA o REGULAR según política
+  static_assert(kSlots > 0, "Slot layout is empty");
+  static_assert(slotLayoutValid<Layout>(), "Slot layout ids must match their table index");
+
+  static constexpr std::array<SlotMask, kSlotTypes> makeTypeMasks() {
+    std::array<SlotMask, kSlotTypes> masks{};
+    for (size_t i = 0; i < kSlots; i++) masks[static_cast<size_t>(Layout::kSlots[i].type)].set(i);
+    return masks;
+  }
+  static constexpr std::array<SlotMask, kLevels> makeLevelMasks() {
+    std::array<SlotMask, kLevels> masks{};
+    for (size_t i = 0; i < kSlots; i++) masks[Layout::kSlots[i].level].set(i);
+    return masks;
+  }
+  static constexpr std::array<SlotMask, kSlotTypes> kTypeMask = makeTypeMasks();
+  static constexpr std::array<SlotMask, kLevels> kLevelMask = makeLevelMasks();
+
+  static const SlotSpec& spec(int idx) { return Layout::kSlots[idx]; }
+
+  // Slot libre del tipo según Pick, o -1
+  int findFree(SlotType t) const;
 
   // Helpers
-  SlotType vehicleClassToSlotType(VehicleClass vc) const;
   void updateSlotState(int idx, uint32_t nowMs);
+  void setSlotState(int idx, SlotState state);
+  void adjustCounters(int idx, SlotState state, int delta);
+  void publishStatus();
+  void reserve(int idx);
   void onSlotOccupied(int idx);
   void onSlotFreed(int idx);
 
-  std::array<Slot, kSlots> slots_;
+  // Caliente: se lee en cada paso / asignación
+  std::array<SlotState, kSlots> state_{};
+  SlotMask freeMask_;                            // Slots en FREE
+  Pick<Layout> pick_;                            // Estado propio de la política
+
+  // Contadores incrementales (setSlotState)
+  uint16_t freeTotal_{0};
+  uint16_t reservedTotal_{0};
+  uint16_t occupiedTotal_{0};
+  std::array<uint16_t, kSlotTypes> freeByType_{};
+  std::array<uint16_t, kLevels> freeByLevel_{};
+  uint32_t version_{0};
+  SeqLock<Status> status_;
+  std::array<uint32_t, kSlots> reservedAtMs_{};  // Momento de la asignación (RESERVED)
+
+  // Frío: configuración de hardware por slot
+  std::array<ProximitySensor, kSlots> sensors_;
+  std::array<TrafficLight, kSlots> lights_;
+
   bool initialized_{false};
-};
\ No newline at end of file
+};
+
+// Instancia del firmware (definida en SlotManager.cpp)
+using ParkingSlots = SlotManager<ParkingLayout>;
+extern template class SlotManager<ParkingLayout>;
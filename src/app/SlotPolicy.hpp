@@ -0,0 +1,197 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include <type_traits>
+#include "core/Bitmap.hpp"
+#include "core/Config.hpp"
+#include "core/Types.hpp"
+#include "app/SlotLayout.hpp"
+
+// Políticas de asignación de SlotManager<Layout, Pick, Fallback>, elegidas
+// en compilación (Cfg::kSlotPick / Cfg::kClassFallback).
+//
+// Fallback: qué tipos de slot probar, en orden, para cada VehicleClass.
+//
+// Pick<Layout>: qué slot elegir entre los libres de un tipo. Todas tienen
+// la misma interfaz; SlotManager les avisa cada cambio de libre/ocupado:
+//   void reset();                 // begin(): todos libres
+//   void onFree(int idx);
+//   void onTaken(int idx);
+//   int pick(SlotType t, const Mask& typeMask, const Mask& freeMask) const;
+// pick() retorna el índice elegido o -1. Con un tipo fijo el compilador
+// resuelve todo en línea: FIRST_FREE es exactamente la búsqueda anterior.
+
+// Grafo de fallback: fila = VehicleClass, tipos a probar en orden
+struct FallbackGraph {
+  SlotType order[3][3];
+  uint8_t count[3];
+};
+
+namespace SlotPolicyDetail {
+  constexpr SlotType kVipSecond = Cfg::kVipFallback == Cfg::VipFallbackPolicy::CARGA_THEN_REGULAR
+                                      ? SlotType::CARGA : SlotType::REGULAR;
+  constexpr SlotType kVipThird = kVipSecond == SlotType::CARGA ? SlotType::REGULAR : SlotType::CARGA;
+}
+
+// Reglas FASE 1/2: cada clase a su tipo; VIP cae a CARGA/REGULAR
+struct VipOnlyFallback {
+  static constexpr FallbackGraph kGraph = {
+    {{SlotType::VIP, SlotPolicyDetail::kVipSecond, SlotPolicyDetail::kVipThird},
+     {SlotType::CARGA},
+     {SlotType::REGULAR}},
+    {3, 1, 1},
+  };
+};
+
+// Como VipOnlyFallback, y un REGULAR puede ocupar un CARGA libre (al revés no:
+// un vehículo de carga no entra en un slot regular)
+struct RegularToCargaFallback {
+  static constexpr FallbackGraph kGraph = {
+    {{SlotType::VIP, SlotPolicyDetail::kVipSecond, SlotPolicyDetail::kVipThird},
+     {SlotType::CARGA},
+     {SlotType::REGULAR, SlotType::CARGA}},
+    {3, 1, 2},
+  };
+};
+
+// El de menor índice (comportamiento original)
+template <typename Layout>
+class FirstFreePick {
+public:
+  using Mask = Bitmap<slotLayoutSize<Layout>()>;
+
+  void reset() {}
+  void onFree(int) {}
+  void onTaken(int) {}
+  int pick(SlotType, const Mask& typeMask, const Mask& freeMask) const {
+    return Mask::firstAnd(typeMask, freeMask);
+  }
+};
+
+// El de menor gateDist. En compilación se ordenan los slots por distancia
+// y se arman los mapas por tipo en ese orden ("rango"); en ejecución se
+// mantiene un mapa de libres por rango, así elegir sigue siendo un ctz.
+template <typename Layout>
+class NearestGatePick {
+  static constexpr size_t kSlots = slotLayoutSize<Layout>();
+  static_assert(kSlots <= 65535, "NearestGatePick ranks fit in 16 bits");
+
+public:
+  using Mask = Bitmap<kSlots>;
+
+  void reset() { freeRank_.setAll(); }
+  void onFree(int idx) { freeRank_.set(kRanking.rankOf[idx]); }
+  void onTaken(int idx) { freeRank_.clear(kRanking.rankOf[idx]); }
+  int pick(SlotType t, const Mask&, const Mask&) const {
+    int rank = Mask::firstAnd(kRanking.typeRank[static_cast<size_t>(t)], freeRank_);
+    return rank < 0 ? -1 : kRanking.order[rank];
+  }
+
+private:
+  struct Ranking {
+    std::array<uint16_t, kSlots> order{};    // rango -> índice
+    std::array<uint16_t, kSlots> rankOf{};   // índice -> rango
+    std::array<Mask, 3> typeRank{};          // Por tipo, en espacio de rangos
+  };
+
+  // Shell sort por (gateDist, índice): estable y barato de evaluar en compilación
+  static constexpr Ranking makeRanking() {
+    Ranking r{};
+    for (size_t i = 0; i < kSlots; i++) r.order[i] = static_cast<uint16_t>(i);
+    auto before = [](uint16_t a, uint16_t b) {
+      return Layout::kSlots[a].gateDist < Layout::kSlots[b].gateDist ||
+             (Layout::kSlots[a].gateDist == Layout::kSlots[b].gateDist && a < b);
+    };
+    for (size_t gap = kSlots / 2; gap > 0; gap /= 2) {
+      for (size_t i = gap; i < kSlots; i++) {
+        uint16_t v = r.order[i];
+        size_t j = i;
+        for (; j >= gap && before(v, r.order[j - gap]); j -= gap) r.order[j] = r.order[j - gap];
+        r.order[j] = v;
+      }
+    }
+    for (size_t rank = 0; rank < kSlots; rank++) {
+      r.rankOf[r.order[rank]] = static_cast<uint16_t>(rank);
+      r.typeRank[static_cast<size_t>(Layout::kSlots[r.order[rank]].type)].set(rank);
+    }
+    return r;
+  }
+  static constexpr Ranking kRanking = makeRanking();
+
+  Mask freeRank_;
+};
+
+// El liberado hace más tiempo: reparte ocupación (y desgaste de sensores y
+// semáforos) entre todos los slots del tipo. Recorre sólo los libres del
+// tipo, nunca más que la búsqueda lineal original.
+template <typename Layout>
+class LeastRecentPick {
+public:
+  using Mask = Bitmap<slotLayoutSize<Layout>()>;
+
+  void reset() {
+    freedSeq_.fill(0);
+    seq_ = 0;
+  }
+  void onFree(int idx) { freedSeq_[idx] = ++seq_; }
+  void onTaken(int) {}
+  int pick(SlotType, const Mask& typeMask, const Mask& freeMask) const {
+    int best = -1;
+    Mask::forEachAnd(typeMask, freeMask, [&](size_t i) {
+      if (best < 0 || freedSeq_[i] < freedSeq_[best]) best = static_cast<int>(i);
+    });
+    return best;
+  }
+
+private:
+  std::array<uint32_t, slotLayoutSize<Layout>()> freedSeq_{};   // Orden de liberación
+  uint32_t seq_{0};
+};
+
+// Nivel más bajo primero: un nivel se empieza a usar cuando los de abajo
+// no tienen lugar del tipo (los de arriba pueden cerrarse en horas bajas)
+template <typename Layout>
+class LevelFillPick {
+  static constexpr size_t kLevels = slotLayoutLevels<Layout>();
+
+public:
+  using Mask = Bitmap<slotLayoutSize<Layout>()>;
+
+  void reset() {}
+  void onFree(int) {}
+  void onTaken(int) {}
+  int pick(SlotType t, const Mask&, const Mask& freeMask) const {
+    for (const Mask& levelMask : kTypeLevel[static_cast<size_t>(t)]) {
+      int slot = Mask::firstAnd(levelMask, freeMask);
+      if (slot >= 0) return slot;
+    }
+    return -1;
+  }
+
+private:
+  using LevelMasks = std::array<std::array<Mask, kLevels>, 3>;
+
+  static constexpr LevelMasks makeTypeLevel() {
+    LevelMasks masks{};
+    size_t i = 0;
+    for (const auto& spec : Layout::kSlots) {
+      masks[static_cast<size_t>(spec.type)][spec.level].set(i++);
+    }
+    return masks;
+  }
+  static constexpr LevelMasks kTypeLevel = makeTypeLevel();   // [tipo][nivel]
+};
+
+// Selección según Cfg
+template <Cfg::SlotPick P> struct PickFor;
+template <> struct PickFor<Cfg::SlotPick::FIRST_FREE> { template <typename L> using Type = FirstFreePick<L>; };
+template <> struct PickFor<Cfg::SlotPick::NEAREST_GATE> { template <typename L> using Type = NearestGatePick<L>; };
+template <> struct PickFor<Cfg::SlotPick::LEAST_RECENT> { template <typename L> using Type = LeastRecentPick<L>; };
+template <> struct PickFor<Cfg::SlotPick::LEVEL_FILL> { template <typename L> using Type = LevelFillPick<L>; };
+
+template <typename Layout>
+using ParkingPick = typename PickFor<Cfg::kSlotPick>::template Type<Layout>;
+
+using ParkingFallback = std::conditional_t<Cfg::kClassFallback == Cfg::ClassFallback::VIP_ONLY,
+                                           VipOnlyFallback, RegularToCargaFallback>;
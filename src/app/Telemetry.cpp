@@ -0,0 +1,152 @@
+#include "Telemetry.hpp"
+#include "AccessController.hpp"
+#include "devices/Barrier.hpp"
+#include "core/Cobs.hpp"
+#include "core/Crc16.hpp"
+#include "core/Logger.hpp"
+#include <string.h>
+
+namespace {
+  size_t putVarint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+      out[n++] = static_cast<uint8_t>(v | 0x80);
+      v >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(v);
+    return n;
+  }
+
+  void putLe(uint8_t* out, uint32_t v, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+
+  size_t putField(uint8_t* out, Telemetry::Field f, uint32_t v) {
+    out[0] = f;
+    return 1 + putVarint(out + 1, v);
+  }
+}
+
+void Telemetry::begin(const AccessController* access, const Barrier* barrier,
+                      const ParkingSlots* slots) {
+  access_ = access;
+  barrier_ = barrier;
+  slots_ = slots;
+  connected_ = false;   // La primera update() con el host conectado manda la foto
+  initialized_ = true;
+  LOG_INFO("Telemetry: binary frames, max %u bytes", (unsigned)kMaxFrame);
+}
+
+void Telemetry::capture(State& s) const {
+  const auto& st = access_->stats();
+  s.access = static_cast<uint8_t>(access_->getState());
+  s.barrier = static_cast<uint8_t>(barrier_->getState());
+  s.queue = access_->queue().size();
+  s.entries = st.entries;
+  s.exits = st.exits;
+  s.denied = st.denied;
+}
+
+void Telemetry::update(uint32_t nowMs) {
+  if (!initialized_) return;
+
+  // Host conectado (USB CDC: terminal abierta; UART: siempre)
+  bool connected = static_cast<bool>(Serial);
+  if (connected && !connected_) {
+    connected_ = true;
+    sendSnapshot(nowMs);
+    return;
+  }
+  connected_ = connected;
+  if (!connected) return;
+
+  State now;
+  capture(now);
+
+  uint8_t frame[kMaxFrame];
+  size_t n = start(frame, FRAME_DELTA, nowMs);
+  const size_t header = n;
+  if (now.access != sent_.access) n += putField(frame + n, FIELD_ACCESS, now.access);
+  if (now.barrier != sent_.barrier) n += putField(frame + n, FIELD_BARRIER, now.barrier);
+  if (now.queue != sent_.queue) n += putField(frame + n, FIELD_QUEUE, now.queue);
+  if (now.entries != sent_.entries) n += putField(frame + n, FIELD_ENTRIES, now.entries);
+  if (now.exits != sent_.exits) n += putField(frame + n, FIELD_EXITS, now.exits);
+  if (now.denied != sent_.denied) n += putField(frame + n, FIELD_DENIED, now.denied);
+
+  // Los slots sólo se recorren si SlotManager publicó un cambio
+  uint32_t version = slots_->status().version;
+  if (version != sent_.slotVersion) {
+    for (size_t i = 0; i < kSlots; i++) {
+      uint8_t st = static_cast<uint8_t>(slots_->getSlotState(static_cast<int>(i)));
+      if (st != sent_.slots[i]) {
+        n += putField(frame + n, FIELD_SLOT, static_cast<uint32_t>(i << 2 | st));
+        sent_.slots[i] = st;
+      }
+    }
+    sent_.slotVersion = version;
+  }
+
+  if (n == header) return;   // Nada cambió: no se emite nada
+  sent_.access = now.access;
+  sent_.barrier = now.barrier;
+  sent_.queue = now.queue;
+  sent_.entries = now.entries;
+  sent_.exits = now.exits;
+  sent_.denied = now.denied;
+  send(frame, n, nowMs);
+}
+
+void Telemetry::sendSnapshot(uint32_t nowMs) {
+  if (!initialized_ || !connected_) return;
+
+  capture(sent_);
+  sent_.slotVersion = slots_->status().version;
+  for (size_t i = 0; i < kSlots; i++) {
+    sent_.slots[i] = static_cast<uint8_t>(slots_->getSlotState(static_cast<int>(i)));
+  }
+
+  uint8_t frame[kMaxFrame];
+  size_t n = start(frame, FRAME_SNAPSHOT, nowMs);
+  frame[n++] = sent_.access;
+  frame[n++] = sent_.barrier;
+  n += putVarint(frame + n, sent_.queue);
+  n += putVarint(frame + n, sent_.entries);
+  n += putVarint(frame + n, sent_.exits);
+  n += putVarint(frame + n, sent_.denied);
+  n += putVarint(frame + n, kSlots);
+
+  // 2 bits por slot, el slot 0 en los bits bajos del primer byte
+  const size_t packed = (kSlots + 3) / 4;
+  memset(frame + n, 0, packed);
+  for (size_t i = 0; i < kSlots; i++) {
+    frame[n + i / 4] |= static_cast<uint8_t>((sent_.slots[i] & 0x03) << (2 * (i % 4)));
+  }
+  n += packed;
+  send(frame, n, nowMs);
+}
+
+size_t Telemetry::start(uint8_t* frame, FrameType type, uint32_t nowMs) {
+  frame[0] = type;
+  putLe(frame + 1, seq_, 2);
+  if (type == FRAME_DELTA) return 3 + putVarint(frame + 3, nowMs - lastFrameMs_);
+  putLe(frame + 3, nowMs, 4);
+  return 7;
+}
+
+void Telemetry::send(uint8_t* frame, size_t len, uint32_t nowMs) {
+  uint16_t crc = Crc16::compute(frame, len);
+  putLe(frame + len, crc, 2);
+  len += 2;
+
+  // Delimitador antes y después: un solo write, sin mezclarse con el log
+  uint8_t encoded[Cobs::maxEncodedSize(kMaxFrame) + 2];
+  encoded[0] = 0x00;
+  size_t n = 1 + Cobs::encode(frame, len, encoded + 1);
+  encoded[n++] = 0x00;
+  Serial.write(encoded, n);
+
+  lastFrameMs_ = nowMs;   // Origen del dt del próximo DELTA
+  seq_++;
+  frames_++;
+  bytes_ += n;
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <Arduino.h>
+#include "core/Config.hpp"
+#include "app/SlotManager.hpp"
+
+class AccessController;
+class Barrier;
+
+// Telemetría binaria por Serial (TELEMETRY_BINARY): el estado de la FSM de
+// acceso, la barrera, la cola, los contadores y cada slot, en frames que
+// sólo salen cuando algo cambia.
+//
+// Frame (antes de COBS): [tipo u8][seq u16][tiempo][payload][crc16 u16]
+//  seq: cuenta cada frame enviado; un salto indica frames perdidos
+//  tiempo: u32 ms absoluto (SNAPSHOT) o varint ms desde el frame anterior
+//          (DELTA)
+//  crc16: CRC-16/CCITT-FALSE de todo lo anterior (core/Crc16.hpp)
+// En el cable: 0x00 + COBS(frame) + 0x00. El 0x00 inicial separa el frame
+// del texto de log que lo preceda; los tipos no chocan con los frames de
+// LogRing (0x01-0x03), así que ambos comparten el stream.
+//
+// Payloads (enteros varint salvo indicación):
+//  SNAPSHOT  [acceso u8][barrera u8][cola][entradas][salidas][rechazos]
+//            [slots][estado de cada slot, 2 bits, 4 por byte]
+//  DELTA     pares [Field u8][valor]; FIELD_SLOT: valor = índice << 2 | estado
+//
+// Un SNAPSHOT sale al conectar el host, a pedido y cada 30 s en lugar del
+// volcado de texto: hace de latido y resincroniza al decodificador tras
+// frames perdidos aunque el enlace sea de una sola vía (captura a archivo).
+//
+// Decodificador: tools/telemetry_decode.py.
+class Telemetry {
+public:
+  enum FrameType : uint8_t { FRAME_SNAPSHOT = 0x10, FRAME_DELTA = 0x11 };
+  enum Field : uint8_t {
+    FIELD_ACCESS = 1,   // AccessState
+    FIELD_BARRIER,      // BarrierState
+    FIELD_SLOT,
+    FIELD_QUEUE,        // Pedidos en cola
+    FIELD_ENTRIES,      // Totales de AccessController::Stats
+    FIELD_EXITS,
+    FIELD_DENIED,
+  };
+
+  void begin(const AccessController* access, const Barrier* barrier, const ParkingSlots* slots);
+
+  // Tras cada paso de control: un DELTA si cambió algo. También nota la
+  // conexión del host (USB CDC) y le manda una foto completa
+  void update(uint32_t nowMs);
+
+  // Foto completa (al conectar, cada 30 s o a pedido: comando 'S')
+  void sendSnapshot(uint32_t nowMs);
+
+  uint32_t framesSent() const { return frames_; }
+  uint32_t bytesSent() const { return bytes_; }
+
+private:
+  static constexpr size_t kSlots = ParkingSlots::kSlots;
+  // Peor caso: un DELTA con todos los campos y todos los slots cambiados
+  static constexpr size_t kMaxFrame = 1 + 2 + 5 + 6 * (1 + 5) + kSlots * (1 + 3) + 2;
+
+  struct State {
+    uint8_t access;
+    uint8_t barrier;
+    uint32_t queue;
+    uint32_t entries;
+    uint32_t exits;
+    uint32_t denied;
+    uint32_t slotVersion;
+    uint8_t slots[kSlots];
+  };
+
+  void capture(State& s) const;
+  size_t start(uint8_t* frame, FrameType type, uint32_t nowMs);
+  void send(uint8_t* frame, size_t len, uint32_t nowMs);
+
+  const AccessController* access_{nullptr};
+  const Barrier* barrier_{nullptr};
+  const ParkingSlots* slots_{nullptr};
+
+  State sent_{};           // Último estado enviado
+  uint32_t lastFrameMs_{0};
+  uint16_t seq_{0};
+  bool connected_{false};
+  bool initialized_{false};
+
+  uint32_t frames_{0};
+  uint32_t bytes_{0};
+};
@@ -0,0 +1,38 @@
+#include "TraceMarks.hpp"
+#include "core/InputTrace.hpp"
+
+void TraceMarks::on(const Events::AccessStateChanged& e) {
+  InputTrace::mark(InputTrace::MARK_ACCESS, static_cast<uint32_t>(e.to));
+}
+
+void TraceMarks::on(const Events::BarrierOpened&) {
+  InputTrace::mark(InputTrace::MARK_BARRIER_OPENED);
+}
+
+void TraceMarks::on(const Events::BarrierClosed&) {
+  InputTrace::mark(InputTrace::MARK_BARRIER_CLOSED);
+}
+
+void TraceMarks::on(const Events::BarrierTimeout& e) {
+  InputTrace::mark(InputTrace::MARK_BARRIER_TIMEOUT, static_cast<uint32_t>(e.state));
+}
+
+void TraceMarks::on(const Events::SlotOccupied& e) {
+  InputTrace::mark(InputTrace::MARK_SLOT_OCCUPIED, static_cast<uint32_t>(e.slotIndex));
+}
+
+void TraceMarks::on(const Events::SlotFreed& e) {
+  InputTrace::mark(InputTrace::MARK_SLOT_FREED, static_cast<uint32_t>(e.slotIndex));
+}
+
+void TraceMarks::on(const Events::CapacityFull& e) {
+  InputTrace::mark(InputTrace::MARK_CAPACITY_FULL, static_cast<uint32_t>(e.deniedClass));
+}
+
+void TraceMarks::on(const Events::SystemFault&) {
+  InputTrace::mark(InputTrace::MARK_FAULT);
+}
+
+void TraceMarks::onDropped(uint32_t count) {
+  InputTrace::mark(InputTrace::MARK_EVENTS_DROPPED, count);
+}
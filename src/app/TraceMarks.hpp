@@ -0,0 +1,20 @@
+#pragma once
+#include "app/Events.hpp"
+
+// Suscriptor del bus que anota en la traza de entradas (core/InputTrace)
+// las transiciones de la FSM de acceso, la barrera y los slots. Al
+// reproducir una traza en el host, comparar estas marcas muestra dónde
+// diverge otro build del firmware. Si el bus perdió eventos, la traza
+// lleva MARK_EVENTS_DROPPED: desde ahí faltan marcas.
+class TraceMarks {
+public:
+  static void on(const Events::AccessStateChanged& e);
+  static void on(const Events::BarrierOpened& e);
+  static void on(const Events::BarrierClosed& e);
+  static void on(const Events::BarrierTimeout& e);
+  static void on(const Events::SlotOccupied& e);
+  static void on(const Events::SlotFreed& e);
+  static void on(const Events::CapacityFull& e);
+  static void on(const Events::SystemFault& e);
+  static void onDropped(uint32_t count);
+};
@@ -0,0 +1,74 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Conjunto de N bits en palabras de 32 (la palabra nativa del ESP32).
+// Buscar el primer bit y contar son ctz/popcount por palabra: con N <= 32
+// es una sola instrucción, y con N grande recorre N/32 palabras en lugar
+// de N elementos.
+//
+// firstAnd()/countAnd() combinan dos mapas palabra a palabra sin armar el
+// intermedio (p.ej. "libres de este tipo" = tipo & libres). Todo es
+// constexpr: un mapa fijo (como los tipos de un layout) puede armarse
+// en compilación.
+template <size_t N>
+class Bitmap {
+  static_assert(N > 0, "Bitmap needs at least one bit");
+
+public:
+  static constexpr size_t kBits = N;
+  static constexpr size_t kWords = (N + 31) / 32;
+
+  constexpr void set(size_t i) { words_[i / 32] |= bit(i); }
+  constexpr void clear(size_t i) { words_[i / 32] &= ~bit(i); }
+  constexpr void assign(size_t i, bool value) { value ? set(i) : clear(i); }
+  constexpr bool test(size_t i) const { return (words_[i / 32] & bit(i)) != 0; }
+
+  constexpr void reset() {
+    for (auto& w : words_) w = 0;
+  }
+  constexpr void setAll() {
+    for (size_t i = 0; i < N; i++) set(i);
+  }
+
+  constexpr size_t count() const {
+    size_t n = 0;
+    for (uint32_t w : words_) n += __builtin_popcount(w);
+    return n;
+  }
+  constexpr bool any() const {
+    for (uint32_t w : words_) if (w) return true;
+    return false;
+  }
+
+  // Índice del primer bit en 1, o -1 si no hay
+  constexpr int first() const { return firstAnd(*this, *this); }
+
+  static constexpr int firstAnd(const Bitmap& a, const Bitmap& b) {
+    for (size_t k = 0; k < kWords; k++) {
+      uint32_t w = a.words_[k] & b.words_[k];
+      if (w) return static_cast<int>(k * 32 + __builtin_ctz(w));
+    }
+    return -1;
+  }
+  static constexpr size_t countAnd(const Bitmap& a, const Bitmap& b) {
+    size_t n = 0;
+    for (size_t k = 0; k < kWords; k++) n += __builtin_popcount(a.words_[k] & b.words_[k]);
+    return n;
+  }
+
+  // fn(i) para cada bit en 1 de (a & b), en orden creciente
+  template <typename Fn>
+  static constexpr void forEachAnd(const Bitmap& a, const Bitmap& b, Fn&& fn) {
+    for (size_t k = 0; k < kWords; k++) {
+      for (uint32_t w = a.words_[k] & b.words_[k]; w; w &= w - 1) {
+        fn(k * 32 + __builtin_ctz(w));
+      }
+    }
+  }
+
+private:
+  static constexpr uint32_t bit(size_t i) { return uint32_t{1} << (i % 32); }
+
+  uint32_t words_[kWords]{};
+};
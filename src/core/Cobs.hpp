@@ -0,0 +1,33 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// Consistent Overhead Byte Stuffing: el frame codificado no contiene 0x00,
+// así que 0x00 sirve de delimitador en el stream Serial.
+namespace Cobs {
+  constexpr size_t maxEncodedSize(size_t len) { return len + len / 254 + 1; }
+
+  // Codifica 'len' bytes en 'out' (sin el delimitador final). Retorna bytes escritos.
+  inline size_t encode(const uint8_t* in, size_t len, uint8_t* out) {
+    size_t codeIdx = 0;
+    size_t outIdx = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++) {
+      if (in[i] == 0) {
+        out[codeIdx] = code;
+        codeIdx = outIdx++;
+        code = 1;
+      } else {
+        out[outIdx++] = in[i];
+        if (++code == 0xFF) {
+          out[codeIdx] = code;
+          codeIdx = outIdx++;
+          code = 1;
+        }
+      }
+    }
+    out[codeIdx] = code;
+    return outIdx;
+  }
+}
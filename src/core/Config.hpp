@@ -1,26 +1,147 @@
 #pragma once
 #include <stdint.h>
+#include <stddef.h>
+
+// Lazo de control (build flag -DLOOP_MODE=...)
+// POLLING: la tarea "control" corre cada kMainUpdateMs haya o no actividad
+// EVENT:   "control" corre ante un flanco de entrada o el próximo vencimiento
+//          (paso de barrera, timeout de la FSM, fin de debounce); idle = dormido
+#define LOOP_MODE_POLLING 0
+#define LOOP_MODE_EVENT   1
+
+#ifndef LOOP_MODE
+#define LOOP_MODE LOOP_MODE_EVENT
+#endif
+
+// Salida del servo de la barrera (build flag -DBARRIER_DRIVE=...)
+// SOFTWARE:  ESP32Servo; la tarea "barrier" escribe el perfil cada kBarrierStepMs
+// LEDC_FADE: el fade por hardware del LEDC recorre cada tramo del perfil y
+//            avisa con la interrupción de fin de fade (requiere ESP-IDF 5)
+#define BARRIER_DRIVE_SOFTWARE  0
+#define BARRIER_DRIVE_LEDC_FADE 1
+
+#ifndef BARRIER_DRIVE
+#define BARRIER_DRIVE BARRIER_DRIVE_SOFTWARE
+#endif
+
+// Estado del sistema por Serial (build flag -DTELEMETRY=...)
+// TEXT:   printSystemStatus() cada 30 s (~27 líneas de texto)
+// BINARY: frames COBS con secuencia y CRC (app/Telemetry.hpp): foto completa
+//         al conectar y cada 30 s, y deltas sólo cuando cambia algo
+#define TELEMETRY_TEXT   0
+#define TELEMETRY_BINARY 1
+
+#ifndef TELEMETRY
+#define TELEMETRY TELEMETRY_TEXT
+#endif
+
+// Almacenamiento del estado global del firmware (instancias de main.cpp,
+// estáticos de los módulos, estado del HAL nativo). Vacío en el ESP32; el
+// barrido paralelo del host compila con -DSEMAFARO_TLS=thread_local para
+// que cada hilo corra su propio firmware
+#ifndef SEMAFARO_TLS
+#define SEMAFARO_TLS
+#endif
 
 namespace Cfg {
   // Tiempos ajustables
-  constexpr uint32_t kPassTimeMs   = 3000;  // Tiempo para pasar después de abrir
+  constexpr uint32_t kPassTimeMs   = 3000;  // Tiempo máximo para pasar después de abrir
   constexpr uint32_t kOpenTimeout  = 5000;  // Timeout para apertura de barrera
   constexpr uint32_t kCloseTimeout = 3000;  // Timeout para cierre de barrera
-  constexpr uint32_t kBarrierStepMs = 20;   // Tiempo entre pasos del servo (movimiento suave)
+  constexpr uint8_t kSafetyRetries = 3;      // Cierres reintentados tras reabrir por el sensor de seguridad
+  constexpr uint32_t kSafetyHoldMs = 30000;  // Sensor de seguridad activo con la barrera reabierta: FAULT
+  constexpr uint32_t kBarrierStepMs = 20;   // Periodo de actualización del servo (un pulso a 50 Hz)
+
+  // Detección de paso en WAIT_PASS: activo -> inactivo cierra sin esperar
+  // kPassTimeMs. SAFETY = sensor de seguridad de la barrera, LOOP = lazo
+  // dedicado en Pins::PASS_LOOP_IN
+  enum class PassSensor { SAFETY, LOOP };
+  constexpr bool kPassDetection = true;
+  constexpr PassSensor kPassSensor = PassSensor::SAFETY;
+
+  // Cola de pedidos de entrada/salida (app/RequestQueue)
+  constexpr size_t kRequestQueueLen = 8;        // Pedidos en espera; si se llena, se descartan
+  constexpr uint32_t kRequestAgingMs = 20000;   // Cada 20s de espera suma un nivel de prioridad
+  constexpr uint32_t kRequestMergeMs = 2000;    // Re-pulsación del mismo pedido: se ignora
+  constexpr uint32_t kSlotReserveMs = 60000;    // Slot asignado sin vehículo: se libera
 
   // Debounces
   constexpr uint16_t kBtnDebounceMs = 30;   // Debounce para botones
   constexpr uint16_t kSensDebounceMs = 30;  // Debounce para sensores inductivos
+  constexpr uint8_t kDebounceBits = 1;      // Contador vertical: 2^bits muestras (a kMainUpdateMs) para aceptar un cambio
+
+  // Entradas: POLLED = muestreo por tick + debounce vertical,
+  // EDGE = ISR por flanco con timestamp + debounce por tiempo exacto
+  enum class InputMode { POLLED, EDGE };
+  constexpr InputMode kInputMode = InputMode::EDGE;
+  constexpr size_t kEdgeQueueLen = 32;      // Flancos en cola (potencia de 2)
 
   // Configuración servo
   constexpr uint8_t kServoClosedDeg = 10;   // Ángulo barrera cerrada
   constexpr uint8_t kServoOpenDeg = 90;     // Ángulo barrera abierta
-  constexpr uint8_t kServoStepDeg = 2;      // Paso de movimiento por tick
+  constexpr uint16_t kServoMinUs = 544;     // Pulso a 0° (default de ESP32Servo)
+  constexpr uint16_t kServoMaxUs = 2400;    // Pulso a 180°
+
+  // Perfil de movimiento de la barrera (core/MotionProfile.hpp): tabla
+  // constexpr indexada por tiempo, escrita en µs cada kBarrierStepMs
+  enum class BarrierProfile { LINEAR, TRAPEZOID, SCURVE };
+  constexpr BarrierProfile kBarrierProfile = BarrierProfile::SCURVE;
+  constexpr uint32_t kBarrierMoveMs = 600;  // Recorrido completo cerrado <-> abierto
+  constexpr size_t kProfileSamples = 64;    // Muestras de la tabla (+1 para t = 1)
+
+  // Backend LEDC_FADE: el perfil se aproxima con tramos rectos por fade
+  constexpr uint8_t kBarrierFadeSegments = 8;
+  constexpr uint8_t kBarrierLedcChannel = 7;  // Fuera de los que asigna ESP32Servo desde 0
+  constexpr uint8_t kBarrierLedcTimer = 3;
+  constexpr uint8_t kBarrierLedcBits = 14;    // Resolución de duty a 50 Hz (máx. del S3)
+  constexpr uint32_t kServoPwmHz = 50;
+
+  // Tiempos de la barrera que Barrier y AccessController copian al
+  // arrancar; setTiming() los cambia en ejecución (barrido del host)
+  struct GateTiming {
+    uint32_t passTimeMs{kPassTimeMs};
+    uint32_t openTimeoutMs{kOpenTimeout};
+    uint32_t closeTimeoutMs{kCloseTimeout};
+    uint32_t moveMs{kBarrierMoveMs};
+  };
 
   // Configuración del scheduler
   constexpr uint32_t kMainUpdateMs = 50;    // 20Hz para update principal
+  constexpr uint32_t kMaxIdleSleepMs = 1000; // Tope de sueño de loop() sin tareas vencidas
+  constexpr size_t kMaxTasks = 8;             // Capacidad fija de la tabla de tareas
+  constexpr size_t kTaskStorageBytes = 16;    // Bytes inline por callable (lambda + capturas)
+  constexpr size_t kSchedulerBudgetBytes = 1536; // Presupuesto de RAM estática del scheduler
+
+  // Bus de eventos (app/AppBus.hpp)
+  constexpr size_t kEventQueueLen = 32;     // Eventos pendientes de entregar (potencia de 2)
+
+  // Log diferido (LOG_MODE DEFERRED/BINARY)
+  constexpr size_t kLogRingBytes = 4096;    // Potencia de 2
+  constexpr size_t kLogMaxFormats = 256;    // Sitios de llamada LOG_* distintos
+  constexpr uint32_t kLogDrainMs = 20;      // Periodo de la tarea de drenado
+
+  // Traza de entradas para reproducir en el host (core/InputTrace.hpp)
+  constexpr size_t kTraceBytes = 8192;            // RAM interna, sin PSRAM (~100 vehículos)
+  constexpr size_t kTracePsramBytes = 2u << 20;   // Con BOARD_HAS_PSRAM (r8n16: 8 MB)
+
+  // Histogramas de métricas (core/Metrics.hpp): log-lineales, en ms
+  constexpr uint8_t kMetricsSubBucketBits = 3;    // 8 buckets por octava: error < 12.5%
+  constexpr uint8_t kMetricsRangeBits = 17;       // Hasta 2^17 ms (~131 s); más, al último
 
   // Política FASE 2: VIP fallback primero a CARGA, luego REGULAR
   enum class VipFallbackPolicy { CARGA_THEN_REGULAR, REGULAR_THEN_CARGA };
   constexpr VipFallbackPolicy kVipFallback = VipFallbackPolicy::CARGA_THEN_REGULAR;
+
+  // Asignación (app/SlotPolicy.hpp), resuelta en compilación.
+  // Qué slot libre del tipo elegir:
+  //   FIRST_FREE: el de menor índice | NEAREST_GATE: menor SlotSpec::gateDist
+  //   LEAST_RECENT: el liberado hace más tiempo (reparte uso y desgaste)
+  //   LEVEL_FILL: llenar el nivel más bajo antes de pasar al siguiente
+  enum class SlotPick { FIRST_FREE, NEAREST_GATE, LEAST_RECENT, LEVEL_FILL };
+  constexpr SlotPick kSlotPick = SlotPick::FIRST_FREE;
+
+  // Tipos alternativos si el propio está lleno (VIP según kVipFallback):
+  //   VIP_ONLY: sólo VIP | REGULAR_TO_CARGA: además REGULAR puede usar CARGA
+  enum class ClassFallback { VIP_ONLY, REGULAR_TO_CARGA };
+  constexpr ClassFallback kClassFallback = ClassFallback::VIP_ONLY;
 }
\ No newline at end of file
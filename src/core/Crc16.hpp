@@ -0,0 +1,19 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+// CRC-16/CCITT-FALSE (polinomio 0x1021, inicial 0xFFFF): detecta frames
+// corruptos en el stream Serial. Bit a bit, sin tabla: los frames son de
+// pocas decenas de bytes y la tabla costaría 512 bytes de flash.
+namespace Crc16 {
+  inline uint16_t compute(const uint8_t* data, size_t len, uint16_t crc = 0xFFFF) {
+    for (size_t i = 0; i < len; i++) {
+      crc ^= static_cast<uint16_t>(data[i]) << 8;
+      for (uint8_t b = 0; b < 8; b++) {
+        crc = (crc & 0x8000) ? static_cast<uint16_t>((crc << 1) ^ 0x1021)
+                             : static_cast<uint16_t>(crc << 1);
+      }
+    }
+    return crc;
+  }
+}
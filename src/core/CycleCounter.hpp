@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+#ifdef SEMAFARO_HOST
+#include <chrono>
+#endif
+
+// Contador de alta resolución para medir duraciones cortas.
+// Placa: contador de ciclos del CPU (CCOUNT). Host: steady_clock en ns.
+// Los valores de now() sólo tienen sentido como diferencias (desbordan).
+namespace CycleCounter {
+#ifdef SEMAFARO_HOST
+  inline uint32_t now() {
+    return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count());
+  }
+
+  inline uint32_t toUs(uint32_t ticks) { return ticks / 1000; }
+#else
+  inline uint32_t now() { return ESP.getCycleCount(); }
+
+  inline uint32_t toUs(uint32_t ticks) { return ticks / ESP.getCpuFreqMHz(); }
+#endif
+}
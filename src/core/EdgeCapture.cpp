@@ -0,0 +1,25 @@
+#include "EdgeCapture.hpp"
+#include <soc/gpio_struct.h>
+
+SEMAFARO_TLS SpscQueue<EdgeCapture::Edge, Cfg::kEdgeQueueLen> EdgeCapture::queue_;
+SEMAFARO_TLS std::atomic<uint32_t> EdgeCapture::overflows_{0};
+SEMAFARO_TLS Scheduler::TaskId EdgeCapture::consumer_ = Scheduler::kInvalidTask;
+
+void EdgeCapture::attach(uint8_t pin) {
+  attachInterruptArg(digitalPinToInterrupt(pin), isr,
+                     reinterpret_cast<void*>(static_cast<uintptr_t>(pin)), CHANGE);
+}
+
+void IRAM_ATTR EdgeCapture::isr(void* arg) {
+  uint8_t pin = static_cast<uint8_t>(reinterpret_cast<uintptr_t>(arg));
+
+  // Nivel directo del registro de entrada (digitalRead no está en IRAM)
+  uint32_t bank = pin < 32 ? static_cast<uint32_t>(GPIO.in)
+                           : static_cast<uint32_t>(GPIO.in1.val);
+  Edge edge{micros(), pin, ((bank >> (pin & 31)) & 1) != 0};
+
+  if (!queue_.push(edge)) {
+    overflows_.fetch_add(1, std::memory_order_relaxed);
+  }
+  if (consumer_ != Scheduler::kInvalidTask) Scheduler::runSoonFromIsr(consumer_);
+}
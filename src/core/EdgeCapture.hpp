@@ -0,0 +1,40 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "Config.hpp"
+#include "Scheduler.hpp"
+#include "SpscQueue.hpp"
+
+// Captura de flancos por interrupción: el ISR de cada pin registrado
+// encola (pin, nivel, µs) en una cola SPSC y pide al Scheduler que
+// ejecute la tarea consumidora en cuanto loop() despierte.
+//
+// Productor único: todos los ISR GPIO comparten un mismo handler en el
+// core donde se registraron, así que nunca se ejecutan a la vez.
+class EdgeCapture {
+public:
+  struct Edge {
+    uint32_t us;     // micros() en el ISR
+    uint8_t pin;
+    bool level;      // Nivel eléctrico tras el flanco (true = HIGH)
+  };
+
+  // Habilitar la interrupción de cambio en 'pin' (ya configurado con pinMode)
+  static void attach(uint8_t pin);
+
+  // Tarea a despertar con cada flanco (kInvalidTask: sólo encolar)
+  static void setConsumer(Scheduler::TaskId id) { consumer_ = id; }
+
+  // Consumidor: siguiente flanco en orden de llegada
+  static bool pop(Edge& edge) { return queue_.pop(edge); }
+
+  // Flancos perdidos por cola llena desde la última llamada
+  static uint32_t takeOverflows() { return overflows_.exchange(0, std::memory_order_relaxed); }
+
+private:
+  static void isr(void* arg);
+
+  static SEMAFARO_TLS SpscQueue<Edge, Cfg::kEdgeQueueLen> queue_;
+  static SEMAFARO_TLS std::atomic<uint32_t> overflows_;
+  static SEMAFARO_TLS Scheduler::TaskId consumer_;
+};
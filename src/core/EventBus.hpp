@@ -0,0 +1,164 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <type_traits>
+#include <utility>
+#include "Config.hpp"
+#include "SpscQueue.hpp"
+
+// Bus de eventos tipado de tamaño fijo, sin heap ni llamadas virtuales.
+//
+// EventVariant<Ts...>: unión etiquetada sobre los structs de evento.
+// SubscriberList<Subs...>: lista de suscriptores fijada en compilación; cada
+// suscriptor es una clase con sobrecargas estáticas on(const Evento&) y sólo
+// recibe los tipos para los que declara una. onDropped(uint32_t), si la
+// declara, avisa de eventos perdidos con el ring lleno.
+// EventBus<Immediate, Deferred, Capacity, Ts...>: publish() entrega el evento
+// en el acto a Immediate (en orden con lo que haga el publicador) y lo copia
+// a un ring fijo (barato, apto para el camino de control); dispatch() lo
+// entrega después a Deferred.
+
+namespace EventDetail {
+  template <typename T, typename... Ts>
+  struct IndexOf;
+
+  template <typename T, typename... Ts>
+  struct IndexOf<T, T, Ts...> : std::integral_constant<uint8_t, 0> {};
+
+  template <typename T, typename U, typename... Ts>
+  struct IndexOf<T, U, Ts...>
+      : std::integral_constant<uint8_t, 1 + IndexOf<T, Ts...>::value> {};
+
+  template <typename T>
+  struct IndexOf<T> {
+    static_assert(sizeof(T) == 0, "Event type is not registered in this bus");
+  };
+
+  constexpr size_t maxOf(size_t a) { return a; }
+  template <typename... Rest>
+  constexpr size_t maxOf(size_t a, size_t b, Rest... rest) {
+    return maxOf(a > b ? a : b, rest...);
+  }
+}
+
+template <typename... Ts>
+class EventVariant {
+  static_assert(sizeof...(Ts) < 255, "Too many event types");
+
+public:
+  template <typename E>
+  static constexpr uint8_t kTag = EventDetail::IndexOf<E, Ts...>::value;
+
+  EventVariant() = default;
+
+  template <typename E>
+  explicit EventVariant(const E& event) : tag_(kTag<E>) {
+    static_assert(std::is_trivially_copyable<E>::value, "Events must be trivially copyable");
+    memcpy(storage_, &event, sizeof(E));
+  }
+
+  uint8_t tag() const { return tag_; }
+
+  // Llama a fn(const E&) con el tipo concreto guardado
+  template <typename F>
+  void visit(F&& fn) const {
+    visitImpl(fn, std::index_sequence_for<Ts...>{});
+  }
+
+private:
+  template <typename F, size_t... Is>
+  void visitImpl(F& fn, std::index_sequence<Is...>) const {
+    // Una comparación por tipo; el compilador la reduce a un switch
+    (void)((tag_ == Is ? (fn(*reinterpret_cast<const Ts*>(storage_)), true) : false) || ...);
+  }
+
+  uint8_t tag_{0xFF};
+  alignas(Ts...) unsigned char storage_[EventDetail::maxOf(sizeof(Ts)...)];
+};
+
+template <typename... Subs>
+struct SubscriberList {
+  template <typename E>
+  static void deliver(const E& event) {
+    (deliverTo<Subs>(event, 0), ...);
+  }
+
+private:
+  // Preferida si S declara on(const E&); si no, el evento se ignora
+  template <typename S, typename E>
+  static auto deliverTo(const E& event, int) -> decltype(S::on(event), void()) {
+    S::on(event);
+  }
+
+  template <typename S, typename E>
+  static void deliverTo(const E&, long) {}
+
+public:
+  static void dropped(uint32_t count) {
+    (droppedTo<Subs>(count, 0), ...);
+  }
+
+private:
+  template <typename S>
+  static auto droppedTo(uint32_t count, int) -> decltype(S::onDropped(count), void()) {
+    S::onDropped(count);
+  }
+
+  template <typename S>
+  static void droppedTo(uint32_t, long) {}
+};
+
+template <typename Immediate, typename Deferred, size_t Capacity, typename... Ts>
+class EventBus {
+public:
+  using Event = EventVariant<Ts...>;
+  static constexpr size_t kCapacity = Capacity;
+
+  // Entregar a Immediate y encolar para Deferred; false (y se cuenta) si el
+  // ring está lleno: Deferred no lo verá, sólo el aviso en dispatch()
+  template <typename E>
+  static bool publish(const E& event) {
+    Immediate::deliver(event);
+    if (queue_.push(Event(event))) return true;
+    dropped_++;
+    unreported_++;
+    return false;
+  }
+
+  // Entregar los eventos pendientes a Deferred, en orden, y después avisar
+  // a ambas listas de los perdidos desde el último dispatch()
+  static size_t dispatch() {
+    size_t count = 0;
+    Event event;
+    while (queue_.pop(event)) {
+      event.visit([](const auto& e) { Deferred::deliver(e); });
+      count++;
+    }
+    if (unreported_ > 0) {
+      uint32_t lost = unreported_;
+      unreported_ = 0;
+      Immediate::dropped(lost);
+      Deferred::dropped(lost);
+    }
+    return count;
+  }
+
+  static size_t pending() { return queue_.size(); }
+  static uint32_t dropped() { return dropped_; }
+
+private:
+  static SEMAFARO_TLS SpscQueue<Event, Capacity> queue_;
+  static SEMAFARO_TLS uint32_t dropped_;
+  static SEMAFARO_TLS uint32_t unreported_;
+};
+
+template <typename Immediate, typename Deferred, size_t Capacity, typename... Ts>
+SEMAFARO_TLS SpscQueue<typename EventBus<Immediate, Deferred, Capacity, Ts...>::Event, Capacity>
+    EventBus<Immediate, Deferred, Capacity, Ts...>::queue_;
+
+template <typename Immediate, typename Deferred, size_t Capacity, typename... Ts>
+SEMAFARO_TLS uint32_t EventBus<Immediate, Deferred, Capacity, Ts...>::dropped_ = 0;
+
+template <typename Immediate, typename Deferred, size_t Capacity, typename... Ts>
+SEMAFARO_TLS uint32_t EventBus<Immediate, Deferred, Capacity, Ts...>::unreported_ = 0;
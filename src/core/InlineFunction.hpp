@@ -0,0 +1,92 @@
+#pragma once
+#include <stddef.h>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+// Callable void() con almacenamiento interno de tamaño fijo.
+// Sustituye a std::function donde no se permite heap: si el callable
+// (lambda + capturas) no cabe en 'Capacity' bytes, falla la compilación.
+template <size_t Capacity>
+class InlineFunction {
+public:
+  static constexpr size_t kCapacity = Capacity;
+
+  InlineFunction() = default;
+  InlineFunction(std::nullptr_t) {}
+
+  template <typename F,
+            typename = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type, InlineFunction>::value>::type>
+  InlineFunction(F&& f) {
+    using Fn = typename std::decay<F>::type;
+    static_assert(sizeof(Fn) <= Capacity,
+                  "Callable too large for InlineFunction: raise Cfg::kTaskStorageBytes");
+    static_assert(alignof(Fn) <= alignof(Storage), "Callable over-aligned for InlineFunction");
+    static_assert(std::is_nothrow_move_constructible<Fn>::value,
+                  "Callable must be nothrow move constructible");
+    new (&storage_) Fn(std::forward<F>(f));
+    ops_ = &OpsFor<Fn>::kOps;
+  }
+
+  InlineFunction(InlineFunction&& other) noexcept { moveFrom(other); }
+
+  InlineFunction& operator=(InlineFunction&& other) noexcept {
+    if (this != &other) {
+      reset();
+      moveFrom(other);
+    }
+    return *this;
+  }
+
+  InlineFunction& operator=(std::nullptr_t) {
+    reset();
+    return *this;
+  }
+
+  InlineFunction(const InlineFunction&) = delete;
+  InlineFunction& operator=(const InlineFunction&) = delete;
+
+  ~InlineFunction() { reset(); }
+
+  void operator()() { ops_->invoke(&storage_); }
+  explicit operator bool() const { return ops_ != nullptr; }
+
+  void reset() {
+    if (ops_) {
+      ops_->destroy(&storage_);
+      ops_ = nullptr;
+    }
+  }
+
+private:
+  struct Ops {
+    void (*invoke)(void*);
+    void (*move)(void* dst, void* src);
+    void (*destroy)(void*);
+  };
+
+  template <typename Fn>
+  struct OpsFor {
+    static void invoke(void* p) { (*static_cast<Fn*>(p))(); }
+    static void move(void* dst, void* src) { new (dst) Fn(std::move(*static_cast<Fn*>(src))); }
+    static void destroy(void* p) { static_cast<Fn*>(p)->~Fn(); }
+    static constexpr Ops kOps{&invoke, &move, &destroy};
+  };
+
+  void moveFrom(InlineFunction& other) {
+    if (other.ops_) {
+      other.ops_->move(&storage_, &other.storage_);
+      ops_ = other.ops_;
+      other.reset();
+    }
+  }
+
+  using Storage = typename std::aligned_storage<Capacity, alignof(void*)>::type;
+  Storage storage_;
+  const Ops* ops_{nullptr};
+};
+
+template <size_t Capacity>
+template <typename Fn>
+constexpr typename InlineFunction<Capacity>::Ops InlineFunction<Capacity>::OpsFor<Fn>::kOps;
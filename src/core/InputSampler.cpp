@@ -0,0 +1,130 @@
+#include "InputSampler.hpp"
+#include "EdgeCapture.hpp"
+#include "InputTrace.hpp"
+#include "Types.hpp"
+#include <soc/gpio_struct.h>
+
+SEMAFARO_TLS uint64_t InputSampler::snapshot_ = 0;
+SEMAFARO_TLS uint64_t InputSampler::watched_ = 0;
+SEMAFARO_TLS uint64_t InputSampler::activeLow_ = 0;
+SEMAFARO_TLS uint32_t InputSampler::samples_ = 0;
+SEMAFARO_TLS InputSampler::Debouncer InputSampler::debouncer_;
+SEMAFARO_TLS uint64_t InputSampler::raw_ = 0;
+SEMAFARO_TLS uint32_t InputSampler::acceptedUs_[64];
+
+namespace {
+  constexpr bool kEdgeMode = Cfg::kInputMode == Cfg::InputMode::EDGE;
+  constexpr uint32_t kDebounceUs =
+      static_cast<uint32_t>(max(Cfg::kBtnDebounceMs, Cfg::kSensDebounceMs)) * 1000;
+}
+
+// El último cambio se acepta (2^bits - 1) periodos después de verse por primera vez
+static_assert((InputSampler::Debouncer::kSamplesToAccept - 1) * Cfg::kMainUpdateMs >=
+                  max(Cfg::kBtnDebounceMs, Cfg::kSensDebounceMs),
+              "Cfg::kDebounceBits too small for the configured debounce times");
+
+void InputSampler::watch(uint8_t pin, bool activeLow) {
+  if (pin >= 64) return;
+  watched_ |= bit(pin);
+  if (activeLow) {
+    activeLow_ |= bit(pin);
+  } else {
+    activeLow_ &= ~bit(pin);
+  }
+
+  bool active = (digitalRead(pin) == HIGH) != activeLow;
+  uint64_t state = debouncer_.state() & ~bit(pin);
+  debouncer_.reset(active ? state | bit(pin) : state);
+  raw_ = debouncer_.state();
+  acceptedUs_[pin] = micros() - kDebounceUs;   // Sin bloqueo inicial
+
+  if (kEdgeMode) EdgeCapture::attach(pin);
+}
+
+void InputSampler::sample() {
+  readRegisters();
+  samples_++;
+
+  if (kEdgeMode) {
+    applyEdges();
+  } else {
+    // Sólo los pines registrados entran al debounce
+    record(debouncer_.update((snapshot_ ^ activeLow_) & watched_));
+  }
+}
+
+void InputSampler::readRegisters() {
+  // GPIO.in: GPIO0-31, GPIO.in1: GPIO32-53 (22 bits válidos en el S3)
+  uint32_t low = GPIO.in;
+  uint32_t high = GPIO.in1.val & 0x3FFFFF;
+  snapshot_ = (static_cast<uint64_t>(high) << 32) | low;
+}
+
+void InputSampler::applyEdges() {
+  EdgeCapture::Edge edge;
+  while (EdgeCapture::pop(edge)) {
+    if (edge.pin >= 64 || !(watched_ & bit(edge.pin))) continue;
+
+    bool active = edge.level != ((activeLow_ >> edge.pin) & 1);
+    raw_ = active ? raw_ | bit(edge.pin) : raw_ & ~bit(edge.pin);
+
+    // Flanco de entrada: aceptar en el acto si no hay ventana de bloqueo abierta
+    bool stable = (debouncer_.state() >> edge.pin) & 1;
+    if (active != stable && edge.us - acceptedUs_[edge.pin] >= kDebounceUs) {
+      accept(edge.pin, edge.us);
+    }
+  }
+
+  // Con flancos perdidos, la foto del tick es la referencia del nivel crudo
+  if (EdgeCapture::takeOverflows() > 0) {
+    raw_ = (snapshot_ ^ activeLow_) & watched_;
+  }
+
+  // Ventanas cerradas con el nivel crudo distinto del estable
+  uint64_t pending = (raw_ ^ debouncer_.state()) & watched_;
+  uint32_t now = micros();
+  while (pending) {
+    uint8_t pin = static_cast<uint8_t>(__builtin_ctzll(pending));
+    pending &= pending - 1;
+    if (now - acceptedUs_[pin] >= kDebounceUs) accept(pin, now);
+  }
+}
+
+uint32_t InputSampler::msUntilNext() {
+  if (!kEdgeMode) return Cfg::kMainUpdateMs;
+
+  uint64_t pending = (raw_ ^ debouncer_.state()) & watched_;
+  if (!pending) return kNoDeadline;
+
+  uint32_t now = micros();
+  uint32_t waitUs = kDebounceUs;
+  while (pending) {
+    uint8_t pin = static_cast<uint8_t>(__builtin_ctzll(pending));
+    pending &= pending - 1;
+    uint32_t since = now - acceptedUs_[pin];
+    waitUs = min(waitUs, since >= kDebounceUs ? 0 : kDebounceUs - since);
+  }
+  return (waitUs + 999) / 1000;
+}
+
+void InputSampler::inject(uint8_t pin, bool level) {
+  if (pin >= 64 || !(watched_ & bit(pin))) return;
+  bool active = level != ((activeLow_ >> pin) & 1);
+  raw_ = active ? raw_ | bit(pin) : raw_ & ~bit(pin);
+  if (active != ((debouncer_.state() >> pin) & 1)) accept(pin, micros());
+}
+
+void InputSampler::accept(uint8_t pin, uint32_t us) {
+  debouncer_.toggle(bit(pin));
+  acceptedUs_[pin] = us;
+  record(bit(pin));
+}
+
+void InputSampler::record(uint64_t changed) {
+  uint64_t levels = debouncer_.state() ^ activeLow_;
+  while (changed) {
+    uint8_t pin = static_cast<uint8_t>(__builtin_ctzll(changed));
+    changed &= changed - 1;
+    InputTrace::input(pin, (levels >> pin) & 1);
+  }
+}
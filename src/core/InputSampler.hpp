@@ -0,0 +1,78 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.hpp"
+#include "VerticalDebouncer.hpp"
+
+// Muestreo de entradas por lotes: una sola lectura de los registros de
+// entrada GPIO (GPIO.in / GPIO.in1) por tick, guardada como máscara de 64
+// bits. Botones y sensores consumen esta foto en vez de llamar a
+// digitalRead(): todos ven el mismo instante y el costo por tick es fijo
+// sin importar cuántos dispositivos haya.
+//
+// El estado estable (bit N = GPIO N, ya normalizado a "activo": se
+// invierten los pines activo-bajo) sale de uno de dos caminos según
+// Cfg::kInputMode:
+//  - POLLED: debounce vertical sobre la foto de cada tick.
+//  - EDGE: flancos de EdgeCapture con su timestamp del ISR. El primer
+//    flanco se acepta en el acto y abre una ventana de bloqueo de
+//    kBtnDebounceMs; al cerrarla, si el nivel crudo quedó distinto, se
+//    acepta también (rebote de la liberación).
+class InputSampler {
+public:
+  using Debouncer = VerticalDebouncer<uint64_t, Cfg::kDebounceBits>;
+
+  // Registrar un pin ya configurado con pinMode(); fija su estado estable
+  // con el nivel actual (sin flanco de arranque). Sólo en setup():
+  // reinicia los contadores de debounce en curso
+  static void watch(uint8_t pin, bool activeLow);
+
+  // Leer los registros de entrada y avanzar el debounce (una vez por tick
+  // y en cada despertar por flanco en modo EDGE)
+  static void sample();
+
+  // Nivel crudo del pin en la última muestra (true = HIGH)
+  static bool level(uint8_t pin) { return pin < 64 && ((snapshot_ >> pin) & 1); }
+
+  // Estado con debounce (true = activo según la polaridad registrada)
+  static bool isActive(uint8_t pin) { return pin < 64 && ((debouncer_.state() >> pin) & 1); }
+
+  // Flancos latcheados desde la última consulta (se consumen al leerlos)
+  static bool takeActivated(uint8_t pin) { return pin < 64 && debouncer_.takeRising(bit(pin)); }
+  static bool takeDeactivated(uint8_t pin) { return pin < 64 && debouncer_.takeFalling(bit(pin)); }
+
+  // Milisegundos hasta que sample() tenga trabajo sin flancos nuevos:
+  // fin de una ventana de bloqueo pendiente (EDGE) o el próximo tick (POLLED)
+  static uint32_t msUntilNext();
+
+  // Modo EDGE: micros() del último cambio aceptado del pin
+  static uint32_t lastChangeUs(uint8_t pin) { return pin < 64 ? acceptedUs_[pin] : 0; }
+
+  // Reproducción de una traza (InputTrace, host/replay): acepta en el acto
+  // el nivel eléctrico 'level' del pin, como si lo decidiera el debounce
+  static void inject(uint8_t pin, bool level);
+
+  // Estado con debounce como niveles eléctricos (bit N = GPIO N registrado)
+  static uint64_t levels() { return (debouncer_.state() ^ activeLow_) & watched_; }
+
+  // Foto completa: bit N = GPIO N
+  static uint64_t snapshot() { return snapshot_; }
+  static uint64_t watched() { return watched_; }
+  static uint32_t sampleCount() { return samples_; }
+
+private:
+  static constexpr uint64_t bit(uint8_t pin) { return uint64_t{1} << pin; }
+  static void readRegisters();
+  static void applyEdges();
+  static void accept(uint8_t pin, uint32_t us);
+  static void record(uint64_t changed);
+
+  static SEMAFARO_TLS uint64_t snapshot_;
+  static SEMAFARO_TLS uint64_t watched_;
+  static SEMAFARO_TLS uint64_t activeLow_;   // Pines a invertir antes del debounce
+  static SEMAFARO_TLS uint32_t samples_;
+  static SEMAFARO_TLS Debouncer debouncer_;
+
+  // Modo EDGE
+  static SEMAFARO_TLS uint64_t raw_;             // Último nivel visto por flanco (normalizado)
+  static SEMAFARO_TLS uint32_t acceptedUs_[64];  // Inicio de la ventana de bloqueo por pin
+};
@@ -0,0 +1,155 @@
+#include "InputTrace.hpp"
+#include "InputSampler.hpp"
+#include "Logger.hpp"
+#include <string.h>
+
+SEMAFARO_TLS uint8_t* InputTrace::buf_ = nullptr;
+SEMAFARO_TLS size_t InputTrace::cap_ = 0;
+SEMAFARO_TLS size_t InputTrace::used_ = 0;
+SEMAFARO_TLS uint32_t InputTrace::dropped_ = 0;
+SEMAFARO_TLS uint32_t InputTrace::startMs_ = 0;
+SEMAFARO_TLS uint32_t InputTrace::lastMs_ = 0;
+SEMAFARO_TLS uint64_t InputTrace::watched_ = 0;
+SEMAFARO_TLS uint64_t InputTrace::levels_ = 0;
+SEMAFARO_TLS bool InputTrace::started_ = false;
+
+namespace {
+#ifndef BOARD_HAS_PSRAM
+  SEMAFARO_TLS uint8_t internal[Cfg::kTraceBytes];
+#endif
+
+  constexpr uint8_t kMagic[4] = {'S', 'T', 'R', 'C'};
+  constexpr size_t kMaxRecordBytes = 5 + 1 + 5;
+  constexpr size_t kDumpLineBytes = 32;
+  constexpr char kHex[] = "0123456789abcdef";
+
+  void putLe(uint8_t* out, uint64_t v, size_t n) {
+    for (size_t i = 0; i < n; i++) out[i] = static_cast<uint8_t>(v >> (8 * i));
+  }
+
+  uint64_t getLe(const uint8_t* in, size_t n) {
+    uint64_t v = 0;
+    for (size_t i = 0; i < n; i++) v |= static_cast<uint64_t>(in[i]) << (8 * i);
+    return v;
+  }
+
+  size_t putVarint(uint8_t* out, uint32_t v) {
+    size_t n = 0;
+    while (v >= 0x80) {
+      out[n++] = static_cast<uint8_t>(v | 0x80);
+      v >>= 7;
+    }
+    out[n++] = static_cast<uint8_t>(v);
+    return n;
+  }
+}
+
+void InputTrace::useBuffer(uint8_t* buf, size_t len) {
+  buf_ = buf;
+  cap_ = len;
+}
+
+void InputTrace::begin() {
+  if (!buf_) {
+#ifdef BOARD_HAS_PSRAM
+    buf_ = static_cast<uint8_t*>(ps_malloc(Cfg::kTracePsramBytes));
+    cap_ = buf_ ? Cfg::kTracePsramBytes : 0;
+#else
+    buf_ = internal;
+    cap_ = sizeof(internal);
+#endif
+  }
+  if (!buf_) {
+    LOG_WARN("Input trace disabled: no PSRAM");
+    return;
+  }
+
+  used_ = 0;
+  dropped_ = 0;
+  startMs_ = millis();
+  lastMs_ = startMs_;
+  watched_ = InputSampler::watched();
+  levels_ = InputSampler::levels();
+  started_ = true;
+  LOG_INFO("Input trace: %u bytes", (unsigned)cap_);
+}
+
+void InputTrace::input(uint8_t pin, bool level) {
+  if (pin >= 64) return;
+  append(static_cast<uint8_t>(pin | (level ? 0x40 : 0)), false, 0);
+}
+
+void InputTrace::mark(Mark kind, uint32_t value) {
+  append(kind, true, value);
+}
+
+void InputTrace::append(uint8_t code, bool hasValue, uint32_t value) {
+  if (!started_) return;
+  if (cap_ - used_ < kMaxRecordBytes) {
+    dropped_++;
+    return;
+  }
+
+  uint32_t now = millis();
+  uint8_t* p = buf_ + used_;
+  size_t n = putVarint(p, now - lastMs_);
+  p[n++] = code;
+  if (hasValue) n += putVarint(p + n, value);
+  used_ += n;
+  lastMs_ = now;
+}
+
+void InputTrace::encodeHeader(uint8_t* out) {
+  uint8_t flags = 0;
+  if (LOOP_MODE == LOOP_MODE_EVENT) flags |= FLAG_LOOP_EVENT;
+  if (Cfg::kInputMode == Cfg::InputMode::EDGE) flags |= FLAG_INPUT_EDGE;
+
+  memcpy(out, kMagic, 4);
+  out[4] = kVersion;
+  out[5] = flags;
+  putLe(out + 6, watched_, 8);
+  putLe(out + 14, levels_, 8);
+  putLe(out + 22, used_, 4);
+  putLe(out + 26, dropped_, 4);
+}
+
+bool InputTrace::decodeHeader(const uint8_t* data, size_t len, Header& h) {
+  if (len < kHeaderBytes || memcmp(data, kMagic, 4) != 0 || data[4] != kVersion) return false;
+  h.flags = data[5];
+  h.watched = getLe(data + 6, 8);
+  h.levels = getLe(data + 14, 8);
+  h.bytes = static_cast<uint32_t>(getLe(data + 22, 4));
+  h.dropped = static_cast<uint32_t>(getLe(data + 26, 4));
+  return h.bytes <= len - kHeaderBytes;
+}
+
+size_t InputTrace::copyTo(uint8_t* out, size_t cap) {
+  if (cap < dumpBytes()) return 0;
+  encodeHeader(out);
+  if (used_ > 0) memcpy(out + kHeaderBytes, buf_, used_);
+  return dumpBytes();
+}
+
+void InputTrace::dump() {
+  uint8_t header[kHeaderBytes];
+  encodeHeader(header);
+
+  // Una línea por cada kDumpLineBytes: el volcado convive con el log de texto
+  Serial.printf("=== TRACE %u bytes, %lu dropped ===\n",
+                (unsigned)dumpBytes(), (unsigned long)dropped_);
+  char line[6 + 2 * kDumpLineBytes + 2];
+  size_t total = dumpBytes();
+  for (size_t off = 0; off < total; off += kDumpLineBytes) {
+    memcpy(line, "TRACE ", 6);
+    size_t n = 6;
+    for (size_t i = off; i < total && i < off + kDumpLineBytes; i++) {
+      uint8_t b = i < kHeaderBytes ? header[i] : buf_[i - kHeaderBytes];
+      line[n++] = kHex[b >> 4];
+      line[n++] = kHex[b & 0x0F];
+    }
+    line[n++] = '\n';
+    line[n] = '\0';
+    Serial.print(line);
+  }
+  Serial.printf("=== TRACE END ===\n");
+}
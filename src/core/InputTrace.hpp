@@ -0,0 +1,140 @@
+#pragma once
+#include <Arduino.h>
+#include "Config.hpp"
+
+// Traza compacta de entradas para reproducir el firmware en el host.
+//
+// Guarda, desde el arranque, cada cambio aceptado por el debounce
+// (InputSampler) y cada transición de la FSM/barrera (app/TraceMarks).
+// Con las entradas alcanza para volver a correr AccessController,
+// SlotManager y Barrier tal cual (host/replay); las marcas sirven para
+// comparar el resultado.
+//
+// Registro: [dt varint][código u8][valor varint, sólo marcas]
+//  dt: ms desde el registro anterior (el primero, desde begin())
+//  código 0x00-0x7F: entrada, bits 0-5 = GPIO, bit 6 = nivel eléctrico
+//  código 0x80-0xFF: marca (Mark), seguida de su valor. MARK_RESET es una
+//  orden desde fuera de la FSM: la reproducción la vuelve a aplicar
+// Un flanco de botón ocupa 2 bytes; un día de tráfico, unos pocos KB.
+//
+// El buffer es lineal, no circular: los deltas sólo se decodifican desde
+// el principio y la FSM sólo se reproduce desde el arranque. Lleno, deja
+// de grabar y cuenta lo perdido. En la placa con PSRAM va ahí
+// (Cfg::kTracePsramBytes); si no, Cfg::kTraceBytes de RAM interna.
+//
+// Productor único: la tarea de loop() (paso de control y AppBus::dispatch()).
+class InputTrace {
+public:
+  enum Mark : uint8_t {
+    MARK_ACCESS = 0x80,       // Valor: AccessState destino
+    MARK_BARRIER_OPENED,
+    MARK_BARRIER_CLOSED,
+    MARK_BARRIER_TIMEOUT,     // Valor: BarrierState en que venció
+    MARK_SLOT_OCCUPIED,       // Valor: índice de slot
+    MARK_SLOT_FREED,
+    MARK_CAPACITY_FULL,       // Valor: VehicleClass rechazada
+    MARK_FAULT,
+    MARK_RESET,               // Orden externa: AccessController::reset() desde FAULT
+    MARK_EVENTS_DROPPED,      // Valor: eventos perdidos por AppBus (faltan sus marcas)
+  };
+
+  // Encabezado del volcado: "STRC", versión, flags, pines registrados y su
+  // nivel estable al empezar, bytes de registros y registros perdidos
+  static constexpr uint8_t kVersion = 1;
+  static constexpr size_t kHeaderBytes = 4 + 1 + 1 + 8 + 8 + 4 + 4;
+  enum Flags : uint8_t { FLAG_LOOP_EVENT = 0x01, FLAG_INPUT_EDGE = 0x02 };
+
+  struct Header {
+    uint8_t flags;
+    uint64_t watched;
+    uint64_t levels;
+    uint32_t bytes;
+    uint32_t dropped;
+  };
+
+  // Un registro decodificado
+  struct Record {
+    uint32_t tMs;     // Desde begin()
+    uint8_t code;
+    uint32_t value;   // Marcas
+
+    bool isInput() const { return code < 0x80; }
+    uint8_t pin() const { return code & 0x3F; }
+    bool level() const { return (code & 0x40) != 0; }
+  };
+
+  // Recorre los registros de un buffer (dispositivo o volcado)
+  class Reader {
+  public:
+    Reader(const uint8_t* data, size_t len) : p_(data), end_(data + len) {}
+
+    // false al terminar o con un registro cortado
+    bool next(Record& r) {
+      uint32_t dt;
+      if (!varint(dt) || p_ >= end_) return false;
+      r.code = *p_++;
+      r.value = 0;
+      if (r.code >= 0x80 && !varint(r.value)) return false;
+      tMs_ += dt;
+      r.tMs = tMs_;
+      return true;
+    }
+
+  private:
+    bool varint(uint32_t& v) {
+      v = 0;
+      for (uint8_t shift = 0; shift < 35 && p_ < end_; shift += 7) {
+        uint8_t b = *p_++;
+        v |= static_cast<uint32_t>(b & 0x7F) << shift;
+        if (!(b & 0x80)) return true;
+      }
+      return false;
+    }
+
+    const uint8_t* p_;
+    const uint8_t* end_;
+    uint32_t tMs_{0};
+  };
+
+  // Buffer externo para programas host (antes de setup(); begin() lo respeta)
+  static void useBuffer(uint8_t* buf, size_t len);
+
+  // Fija el origen de tiempo y el estado inicial de las entradas. Al final
+  // de setup(), con todos los pines ya registrados en InputSampler
+  static void begin();
+
+  // Cambio estable de un pin (nivel eléctrico, true = HIGH)
+  static void input(uint8_t pin, bool level);
+
+  // Transición de la FSM o la barrera
+  static void mark(Mark kind, uint32_t value = 0);
+
+  // Encabezado + registros en 'out'; retorna los bytes escritos (0 si no entra)
+  static size_t copyTo(uint8_t* out, size_t cap);
+  static size_t dumpBytes() { return kHeaderBytes + used_; }
+
+  // Volcado por Serial en líneas "TRACE <hex>" (ver host/replay)
+  static void dump();
+
+  static bool decodeHeader(const uint8_t* data, size_t len, Header& h);
+
+  // millis() en begin(): origen de Record::tMs
+  static uint32_t startMs() { return startMs_; }
+  static size_t used() { return used_; }
+  static size_t capacity() { return cap_; }
+  static uint32_t dropped() { return dropped_; }
+
+private:
+  static void append(uint8_t code, bool hasValue, uint32_t value);
+  static void encodeHeader(uint8_t* out);
+
+  static SEMAFARO_TLS uint8_t* buf_;
+  static SEMAFARO_TLS size_t cap_;
+  static SEMAFARO_TLS size_t used_;
+  static SEMAFARO_TLS uint32_t dropped_;
+  static SEMAFARO_TLS uint32_t startMs_;
+  static SEMAFARO_TLS uint32_t lastMs_;
+  static SEMAFARO_TLS uint64_t watched_;
+  static SEMAFARO_TLS uint64_t levels_;
+  static SEMAFARO_TLS bool started_;
+};
@@ -0,0 +1,19 @@
+#pragma once
+#include <stdint.h>
+
+// Ids de formato de log calculados en compilación (LOG_MODE_CATALOG).
+// Debe coincidir byte a byte con tools/gen_log_catalog.py: FNV-1a de 32 bits
+// sobre "prefijo + formato" en UTF-8; 0xFFFFFFFF se reserva (LogRing::kNoFormat).
+namespace LogCatalog {
+  constexpr uint32_t kFnvOffset = 2166136261u;
+  constexpr uint32_t kFnvPrime = 16777619u;
+
+  constexpr uint32_t id(const char* fmt) {
+    uint32_t h = kFnvOffset;
+    for (const char* p = fmt; *p; p++) {
+      h ^= static_cast<uint8_t>(*p);
+      h *= kFnvPrime;
+    }
+    return h == 0xFFFFFFFFu ? 0xFFFFFFFEu : h;
+  }
+}
@@ -0,0 +1,317 @@
+#include "LogRing.hpp"
+#include "Cobs.hpp"
+#include "Logger.hpp"
+#include "Scheduler.hpp"
+#include <stdio.h>
+#include <string.h>
+
+SEMAFARO_TLS uint8_t LogRing::ring_[LogRing::kRingBytes];
+SEMAFARO_TLS std::atomic<uint32_t> LogRing::head_{0};
+SEMAFARO_TLS std::atomic<uint32_t> LogRing::tail_{0};
+SEMAFARO_TLS std::atomic<uint32_t> LogRing::dropped_{0};
+SEMAFARO_TLS uint32_t LogRing::droppedTotal_ = 0;
+
+SEMAFARO_TLS const char* LogRing::formats_[Cfg::kLogMaxFormats];
+SEMAFARO_TLS std::atomic<uint16_t> LogRing::formatCount_{0};
+SEMAFARO_TLS uint32_t LogRing::announced_[(Cfg::kLogMaxFormats + 31) / 32];
+
+uint32_t LogRing::intern(const char* fmt) {
+  uint16_t id = formatCount_.load(std::memory_order_relaxed);
+  if (id >= Cfg::kLogMaxFormats) return kNoFormat;
+  formats_[id] = fmt;
+  // Publicar el puntero antes que el contador: el consumidor lee por id
+  formatCount_.store(id + 1, std::memory_order_release);
+  return id;
+}
+
+// ---- Productor ----
+
+void LogRing::pushArgs(uint32_t fmtId, const Arg* args, size_t count) {
+  if (fmtId == kNoFormat) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  uint8_t rec[kMaxRecordBytes + 1];
+  size_t len = 1;
+  auto put = [&](const void* data, size_t n) {
+    memcpy(rec + len, data, n);
+    len += n;
+  };
+
+  put(&fmtId, sizeof(fmtId));
+  uint32_t ts = millis();
+  put(&ts, sizeof(ts));
+
+  // Cada argumento entra completo o no entra: el primero que no cabe corta
+  // el registro con ARG_TRUNC (su byte queda siempre reservado) y los
+  // siguientes se descartan, así no se corren de lugar en el formato
+  const size_t room = sizeof(rec) - 1;
+  for (size_t i = 0; i < count; i++) {
+    const Arg& a = args[i];
+    const char* str = nullptr;
+    uint8_t strLen = 0;
+    size_t need = 1;
+    switch (a.tag) {
+      case ARG_I32:
+      case ARG_U32:
+        need += sizeof(a.u32);
+        break;
+      case ARG_I64:
+      case ARG_U64:
+        need += sizeof(a.u64);
+        break;
+      case ARG_F64:
+        need += sizeof(a.f64);
+        break;
+      case ARG_STR:
+        str = a.str ? a.str : "(null)";
+        strLen = static_cast<uint8_t>(strnlen(str, kMaxStringArg));
+        need += 1 + strLen;
+        break;
+    }
+    if (len + need > room) {
+      uint8_t trunc = ARG_TRUNC;
+      put(&trunc, 1);
+      break;
+    }
+
+    put(&a.tag, 1);
+    switch (a.tag) {
+      case ARG_I32:
+      case ARG_U32:
+        put(&a.u32, sizeof(a.u32));
+        break;
+      case ARG_I64:
+      case ARG_U64:
+        put(&a.u64, sizeof(a.u64));
+        break;
+      case ARG_F64:
+        put(&a.f64, sizeof(a.f64));
+        break;
+      case ARG_STR:
+        put(&strLen, 1);
+        put(str, strLen);
+        break;
+    }
+  }
+
+  rec[0] = static_cast<uint8_t>(len - 1);
+  write(rec, len);
+}
+
+void LogRing::write(const uint8_t* rec, size_t len) {
+  uint32_t head = head_.load(std::memory_order_relaxed);
+  uint32_t tail = tail_.load(std::memory_order_acquire);
+
+  if (kRingBytes - (head - tail) < len) {
+    dropped_.fetch_add(1, std::memory_order_relaxed);
+    return;
+  }
+
+  size_t offset = head & (kRingBytes - 1);
+  size_t first = min(len, kRingBytes - offset);
+  memcpy(ring_ + offset, rec, first);
+  memcpy(ring_, rec + first, len - first);
+
+  head_.store(head + len, std::memory_order_release);
+}
+
+// ---- Consumidor ----
+
+size_t LogRing::readRecord(uint8_t* rec) {
+  uint32_t tail = tail_.load(std::memory_order_relaxed);
+  uint32_t head = head_.load(std::memory_order_acquire);
+  if (head == tail) return 0;
+
+  size_t len = static_cast<size_t>(ring_[tail & (kRingBytes - 1)]) + 1;
+  for (size_t i = 0; i < len; i++) {
+    rec[i] = ring_[(tail + i) & (kRingBytes - 1)];
+  }
+
+  tail_.store(tail + len, std::memory_order_release);
+  return len;
+}
+
+void LogRing::drain() {
+  reportDropped();
+
+  uint8_t rec[kMaxRecordBytes + 1];
+  size_t len;
+  while ((len = readRecord(rec)) > 0) {
+#if LOG_MODE == LOG_MODE_BINARY || LOG_MODE == LOG_MODE_CATALOG
+    emitBinary(rec, len);
+#else
+    emitText(rec, len);
+#endif
+  }
+}
+
+void LogRing::reportDropped() {
+  uint32_t dropped = dropped_.exchange(0, std::memory_order_relaxed);
+  if (dropped == 0) return;
+  droppedTotal_ += dropped;
+
+#if LOG_MODE == LOG_MODE_BINARY || LOG_MODE == LOG_MODE_CATALOG
+  uint8_t frame[1 + sizeof(dropped)];
+  frame[0] = FRAME_DROPPED;
+  memcpy(frame + 1, &dropped, sizeof(dropped));
+  emitFrame(frame, sizeof(frame));
+#else
+  Serial.printf("[WARN ] Log ring overflow: %lu records dropped\n", (unsigned long)dropped);
+#endif
+}
+
+void LogRing::emitText(const uint8_t* rec, size_t len) {
+  uint32_t fmtId;
+  memcpy(&fmtId, rec + 1, sizeof(fmtId));
+  if (fmtId >= formatCount_.load(std::memory_order_acquire)) return;
+
+  char line[192];
+  size_t n = format(formats_[fmtId], rec + 9, len - 9, line, sizeof(line) - 1);
+  line[n++] = '\n';   // format() deja lugar: se le pasó un byte menos
+  Serial.write(reinterpret_cast<const uint8_t*>(line), n);
+}
+
+void LogRing::emitBinary(const uint8_t* rec, size_t len) {
+  uint32_t fmtId;
+  memcpy(&fmtId, rec + 1, sizeof(fmtId));
+
+#if LOG_MODE != LOG_MODE_CATALOG
+  if (fmtId >= formatCount_.load(std::memory_order_acquire)) return;
+
+  // Primera aparición del formato: enviar el texto una sola vez
+  uint32_t bit = 1UL << (fmtId % 32);
+  if (!(announced_[fmtId / 32] & bit)) {
+    uint8_t frame[1 + sizeof(fmtId) + kMaxRecordBytes];
+    size_t n = min(strlen(formats_[fmtId]), kMaxRecordBytes);
+    frame[0] = FRAME_FORMAT;
+    memcpy(frame + 1, &fmtId, sizeof(fmtId));
+    memcpy(frame + 1 + sizeof(fmtId), formats_[fmtId], n);
+    emitFrame(frame, 1 + sizeof(fmtId) + n);
+    announced_[fmtId / 32] |= bit;
+  }
+#endif
+
+  // El cuerpo del registro (sin el byte de longitud) es el payload del frame
+  uint8_t frame[kMaxRecordBytes + 1];
+  frame[0] = FRAME_RECORD;
+  memcpy(frame + 1, rec + 1, len - 1);
+  emitFrame(frame, len);
+}
+
+void LogRing::emitFrame(const uint8_t* frame, size_t len) {
+  uint8_t encoded[Cobs::maxEncodedSize(kMaxRecordBytes + 3) + 1];
+  size_t n = Cobs::encode(frame, len, encoded);
+  encoded[n++] = 0x00;
+  Serial.write(encoded, n);
+}
+
+// ---- Formateo ----
+
+size_t LogRing::format(const char* fmt, const uint8_t* args, size_t argsLen,
+                       char* out, size_t outSize) {
+  if (outSize == 0) return 0;
+  size_t o = 0;
+  size_t a = 0;
+  // snprintf siempre deja el terminador dentro de outSize
+  auto emit = [&](int n) { if (n > 0) o = min(o + static_cast<size_t>(n), outSize - 1); };
+
+  for (const char* p = fmt; *p && o < outSize - 1; p++) {
+    if (*p != '%') {
+      out[o++] = *p;
+      continue;
+    }
+    if (p[1] == '%') {
+      out[o++] = '%';
+      p++;
+      continue;
+    }
+
+    // Copiar flags/ancho/precisión, descartar modificadores de longitud
+    char spec[16] = "%";
+    size_t s = 1;
+    const char* q = p + 1;
+    while (*q && strchr("-+ #0123456789.", *q) && s < sizeof(spec) - 4) spec[s++] = *q++;
+    while (*q && strchr("hlLqjzt", *q)) q++;
+    char conv = *q;
+    if (!conv) break;
+    p = q;
+
+    if (a >= argsLen || args[a] == ARG_TRUNC) {
+      a = argsLen;   // Registro truncado: el resto de los argumentos no está
+      emit(snprintf(out + o, outSize - o, "<?>"));
+      continue;
+    }
+    uint8_t tag = args[a++];
+
+    if (tag == ARG_STR && a < argsLen) {
+      size_t n = args[a++];
+      n = min(n, argsLen - a);
+      char str[kMaxStringArg + 1];
+      memcpy(str, args + a, n);
+      str[n] = '\0';
+      a += n;
+      spec[s++] = 's';
+      emit(snprintf(out + o, outSize - o, spec, str));
+    } else if (tag == ARG_F64 && a + 8 <= argsLen) {
+      double v;
+      memcpy(&v, args + a, 8);
+      a += 8;
+      spec[s++] = strchr("eEfFgGaA", conv) ? conv : 'g';
+      emit(snprintf(out + o, outSize - o, spec, v));
+    } else if ((tag == ARG_I32 || tag == ARG_U32) && a + 4 <= argsLen) {
+      uint32_t raw;
+      memcpy(&raw, args + a, 4);
+      a += 4;
+      long long v = tag == ARG_I32 ? static_cast<long long>(static_cast<int32_t>(raw))
+                                   : static_cast<long long>(raw);
+      if (conv == 'c') {
+        spec[s++] = 'c';
+        emit(snprintf(out + o, outSize - o, spec, static_cast<int>(v)));
+      } else {
+        spec[s++] = 'l';
+        spec[s++] = 'l';
+        spec[s++] = strchr("diouxX", conv) ? conv : 'd';
+        emit(snprintf(out + o, outSize - o, spec, v));
+      }
+    } else if ((tag == ARG_I64 || tag == ARG_U64) && a + 8 <= argsLen) {
+      uint64_t raw;
+      memcpy(&raw, args + a, 8);
+      a += 8;
+      spec[s++] = 'l';
+      spec[s++] = 'l';
+      spec[s++] = strchr("diouxX", conv) ? conv : 'd';
+      emit(snprintf(out + o, outSize - o, spec, static_cast<long long>(raw)));
+    } else {
+      break;   // Registro truncado
+    }
+  }
+  out[o] = '\0';
+  return o;
+}
+
+// ---- Tarea de drenado ----
+
+#if LOG_MODE == LOG_MODE_SYNC
+void LogRing::begin() {}   // Log síncrono: no hay nada que drenar
+#elif defined(SEMAFARO_HOST)
+void LogRing::begin() {
+  Scheduler::every(Cfg::kLogDrainMs, []() { LogRing::drain(); }, "logdrain");
+}
+#else
+namespace {
+  void drainTask(void*) {
+    for (;;) {
+      LogRing::drain();
+      vTaskDelay(pdMS_TO_TICKS(Cfg::kLogDrainMs));
+    }
+  }
+}
+
+void LogRing::begin() {
+  // Prioridad mínima sobre el idle, en el core opuesto al de loop()
+  xTaskCreatePinnedToCore(drainTask, "logdrain", 4096, nullptr, tskIDLE_PRIORITY + 1,
+                          nullptr, ARDUINO_RUNNING_CORE == 0 ? 1 : 0);
+}
+#endif
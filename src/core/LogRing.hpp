@@ -0,0 +1,117 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include <type_traits>
+#include "Config.hpp"
+
+// Log diferido: las macros LOG_* sólo copian (id de formato, timestamp,
+// argumentos crudos) a un ring lock-free; el formateo y la escritura a
+// Serial ocurren después, en la tarea de drenado (baja prioridad).
+//
+// Productor único: la tarea de loop(). Consumidor único: drain().
+//
+// Registro en el ring: [len u8][fmtId u32][tsMs u32][args...]
+// fmtId: índice interno (DEFERRED/BINARY) o hash del catálogo (CATALOG).
+// Cada argumento: [tag u8][payload] (ver LogRing::ArgTag). Si no caben
+// todos, el registro termina en ARG_TRUNC (sin payload) y el formateo
+// muestra "<?>" en los que faltan.
+class LogRing {
+public:
+  enum ArgTag : uint8_t { ARG_I32 = 1, ARG_U32, ARG_I64, ARG_U64, ARG_F64, ARG_STR, ARG_TRUNC };
+
+  // Tipos de frame del stream binario (COBS, delimitados por 0x00)
+  enum FrameType : uint8_t { FRAME_FORMAT = 0x01, FRAME_RECORD = 0x02, FRAME_DROPPED = 0x03 };
+
+  static constexpr uint32_t kNoFormat = 0xFFFFFFFF;
+  static constexpr size_t kMaxRecordBytes = 255;
+  static constexpr size_t kMaxStringArg = 32;
+
+  // Registra un formato y retorna su id (una vez por sitio de llamada)
+  static uint32_t intern(const char* fmt);
+
+  // Argumento ya clasificado; el sitio de llamada sólo arma un arreglo de
+  // estos y llama a pushArgs() (fuera de línea), como haría con printf
+  struct Arg {
+    uint8_t tag;
+    union {
+      uint32_t u32;
+      uint64_t u64;
+      double f64;
+      const char* str;
+    };
+  };
+
+  template <typename... Args>
+  static void push(uint32_t fmtId, Args... args) {
+    const Arg list[] = {makeArg(args)..., Arg{}};   // Centinela: evita arreglo vacío
+    pushArgs(fmtId, list, sizeof...(Args));
+  }
+
+  static void pushArgs(uint32_t fmtId, const Arg* args, size_t count);
+
+  // Drenar registros pendientes hacia Serial (texto o binario según LOG_MODE)
+  // En modo CATALOG el dispositivo no tiene los textos: siempre binario.
+  static void drain();
+
+  // Arranca el drenado: tarea FreeRTOS de baja prioridad en la placa,
+  // tarea del Scheduler en el build nativo
+  static void begin();
+
+  // Formatea los argumentos de un registro según 'fmt' (texto terminado en NUL)
+  static size_t format(const char* fmt, const uint8_t* args, size_t argsLen,
+                       char* out, size_t outSize);
+
+  static uint32_t droppedTotal() { return droppedTotal_; }
+
+private:
+  static constexpr size_t kRingBytes = Cfg::kLogRingBytes;
+  static_assert((kRingBytes & (kRingBytes - 1)) == 0, "Cfg::kLogRingBytes must be a power of two");
+
+  template <typename T>
+  static typename std::enable_if<std::is_integral<T>::value || std::is_enum<T>::value, Arg>::type
+  makeArg(T value) {
+    using U = typename std::conditional<std::is_enum<T>::value, int, T>::type;
+    Arg a;
+    if (sizeof(U) > 4) {
+      a.tag = std::is_signed<U>::value ? ARG_I64 : ARG_U64;
+      a.u64 = static_cast<uint64_t>(static_cast<U>(value));
+    } else {
+      a.tag = std::is_signed<U>::value ? ARG_I32 : ARG_U32;
+      a.u32 = static_cast<uint32_t>(static_cast<U>(value));
+    }
+    return a;
+  }
+
+  template <typename T>
+  static typename std::enable_if<std::is_floating_point<T>::value, Arg>::type
+  makeArg(T value) {
+    Arg a;
+    a.tag = ARG_F64;
+    a.f64 = value;
+    return a;
+  }
+
+  static Arg makeArg(const char* str) {
+    Arg a;
+    a.tag = ARG_STR;
+    a.str = str;
+    return a;
+  }
+
+  static void write(const uint8_t* rec, size_t len);
+  static size_t readRecord(uint8_t* rec);
+  static void emitText(const uint8_t* rec, size_t len);
+  static void emitBinary(const uint8_t* rec, size_t len);
+  static void emitFrame(const uint8_t* frame, size_t len);
+  static void reportDropped();
+
+  static SEMAFARO_TLS uint8_t ring_[kRingBytes];
+  static SEMAFARO_TLS std::atomic<uint32_t> head_;     // Escrito por el productor
+  static SEMAFARO_TLS std::atomic<uint32_t> tail_;     // Escrito por el consumidor
+  static SEMAFARO_TLS std::atomic<uint32_t> dropped_;  // Registros perdidos desde el último reporte
+  static SEMAFARO_TLS uint32_t droppedTotal_;
+
+  static SEMAFARO_TLS const char* formats_[Cfg::kLogMaxFormats];
+  static SEMAFARO_TLS std::atomic<uint16_t> formatCount_;
+  static SEMAFARO_TLS uint32_t announced_[(Cfg::kLogMaxFormats + 31) / 32];  // Binario: formatos ya enviados
+};
@@ -11,26 +11,61 @@
 #define LOG_LEVEL LOG_LEVEL_INFO
 #endif
 
+// Modos de salida (build flag -DLOG_MODE=...)
+// SYNC:     Serial.printf en el punto de llamada (comportamiento original)
+// DEFERRED: ring lock-free + tarea de drenado que formatea a texto
+// BINARY:   ring lock-free + frames COBS binarios (decodificar con tools/log_decode.py)
+// CATALOG:  como BINARY, pero el id es un hash constexpr del formato y los textos no
+//           llegan al firmware; viven en el catálogo generado (tools/gen_log_catalog.py)
+#define LOG_MODE_SYNC     0
+#define LOG_MODE_DEFERRED 1
+#define LOG_MODE_BINARY   2
+#define LOG_MODE_CATALOG  3
+
+#ifndef LOG_MODE
+#define LOG_MODE LOG_MODE_SYNC
+#endif
+
+#if LOG_MODE == LOG_MODE_SYNC
+#define LOG_EMIT(prefix, msg, ...) do { Serial.printf(prefix msg "\n", ##__VA_ARGS__); } while(0)
+#elif LOG_MODE == LOG_MODE_CATALOG
+#include "LogRing.hpp"
+#include "LogCatalog.hpp"
+// El literal sólo se usa en evaluación constante: no se emite a .rodata
+#define LOG_EMIT(prefix, msg, ...) do { \
+    constexpr uint32_t logFmtId = LogCatalog::id(prefix msg); \
+    LogRing::push(logFmtId, ##__VA_ARGS__); \
+  } while(0)
+#else
+#include "LogRing.hpp"
+// El id del formato se asigna una sola vez por sitio de llamada (por hilo
+// con SEMAFARO_TLS: cada firmware del barrido tiene su tabla de formatos)
+#define LOG_EMIT(prefix, msg, ...) do { \
+    static SEMAFARO_TLS const uint32_t logFmtId = LogRing::intern(prefix msg); \
+    LogRing::push(logFmtId, ##__VA_ARGS__); \
+  } while(0)
+#endif
+
 #if LOG_LEVEL >= LOG_LEVEL_ERROR
-#define LOG_ERR(msg, ...) do { Serial.printf("[ERROR] " msg "\n", ##__VA_ARGS__); } while(0)
+#define LOG_ERR(msg, ...) LOG_EMIT("[ERROR] ", msg, ##__VA_ARGS__)
 #else
 #define LOG_ERR(msg, ...)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_WARN
-#define LOG_WARN(msg, ...) do { Serial.printf("[WARN ] " msg "\n", ##__VA_ARGS__); } while(0)
+#define LOG_WARN(msg, ...) LOG_EMIT("[WARN ] ", msg, ##__VA_ARGS__)
 #else
 #define LOG_WARN(msg, ...)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_INFO
-#define LOG_INFO(msg, ...) do { Serial.printf("[INFO ] " msg "\n", ##__VA_ARGS__); } while(0)
+#define LOG_INFO(msg, ...) LOG_EMIT("[INFO ] ", msg, ##__VA_ARGS__)
 #else
 #define LOG_INFO(msg, ...)
 #endif
 
 #if LOG_LEVEL >= LOG_LEVEL_DEBUG
-#define LOG_DEBUG(msg, ...) do { Serial.printf("[DEBUG] " msg "\n", ##__VA_ARGS__); } while(0)
+#define LOG_DEBUG(msg, ...) LOG_EMIT("[DEBUG] ", msg, ##__VA_ARGS__)
 #else
 #define LOG_DEBUG(msg, ...)
 #endif
\ No newline at end of file
@@ -0,0 +1,97 @@
+#include "Metrics.hpp"
+#include <stdio.h>
+
+SEMAFARO_TLS std::atomic<uint32_t> Metrics::counters_[Metrics::kCounters];
+SEMAFARO_TLS std::atomic<uint32_t> Metrics::gauges_[Metrics::kGauges];
+SEMAFARO_TLS Metrics::Hist Metrics::histograms_[Metrics::kHistograms];
+
+namespace {
+  // Nombres en el orden de cada enum (el registro de métricas)
+  constexpr const char* kCounterNames[] = {
+    "access.entry.vip", "access.entry.carga", "access.entry.regular", "access.exits",
+    "access.denied.vip", "access.denied.carga", "access.denied.regular",
+    "access.open_timeouts", "access.close_timeouts", "access.faults",
+    "barrier.safety_stops", "barrier.timeouts",
+  };
+  constexpr const char* kGaugeNames[] = {
+    "access.state", "barrier.state", "access.queue_depth",
+  };
+  constexpr const char* kHistogramNames[] = {
+    "access.open_latency_ms", "access.cycle_ms", "access.pass_ms", "barrier.move_ms",
+  };
+  static_assert(sizeof(kCounterNames) / sizeof(kCounterNames[0]) == Metrics::kCounters,
+                "Every Metrics::Counter needs a name");
+  static_assert(sizeof(kGaugeNames) / sizeof(kGaugeNames[0]) == Metrics::kGauges,
+                "Every Metrics::Gauge needs a name");
+  static_assert(sizeof(kHistogramNames) / sizeof(kHistogramNames[0]) == Metrics::kHistograms,
+                "Every Metrics::Histogram needs a name");
+
+  // Snapshot del volcado: ~2 KB, fuera del stack de loop()
+  SEMAFARO_TLS Metrics::Snapshot dumpSnapshot;
+}
+
+const char* Metrics::name(Counter c) { return kCounterNames[static_cast<size_t>(c)]; }
+const char* Metrics::name(Gauge g) { return kGaugeNames[static_cast<size_t>(g)]; }
+const char* Metrics::name(Histogram h) { return kHistogramNames[static_cast<size_t>(h)]; }
+
+uint32_t Metrics::HistogramSnapshot::percentile(uint32_t q) const {
+  if (count == 0) return 0;
+  // Rango de la muestra buscada (1..count), redondeado hacia arriba
+  uint64_t rank = (static_cast<uint64_t>(count) * q + 99) / 100;
+  if (rank == 0) rank = 1;
+  uint64_t seen = 0;
+  for (size_t b = 0; b < kBuckets; b++) {
+    seen += buckets[b];
+    if (seen >= rank) return min(upperBound(b), max);
+  }
+  return max;
+}
+
+void Metrics::snapshot(Snapshot& out) {
+  out.uptimeMs = millis();
+  for (size_t i = 0; i < kCounters; i++) out.counters[i] = counters_[i].load(std::memory_order_relaxed);
+  for (size_t i = 0; i < kGauges; i++) out.gauges[i] = gauges_[i].load(std::memory_order_relaxed);
+  for (size_t h = 0; h < kHistograms; h++) {
+    const Hist& src = histograms_[h];
+    HistogramSnapshot& dst = out.histograms[h];
+    dst.count = src.count.load(std::memory_order_relaxed);
+    dst.max = src.max.load(std::memory_order_relaxed);
+    for (size_t b = 0; b < kBuckets; b++) dst.buckets[b] = src.buckets[b].load(std::memory_order_relaxed);
+  }
+}
+
+void Metrics::dump() {
+  Snapshot& s = dumpSnapshot;
+  snapshot(s);
+
+  // Serial directo, como InputTrace::dump(): legible también con LOG_MODE CATALOG
+  Serial.printf("=== METRICS uptime %lu ms ===\n", (unsigned long)s.uptimeMs);
+  for (size_t i = 0; i < kCounters; i++) {
+    Serial.printf("counter %s %lu\n", kCounterNames[i], (unsigned long)s.counters[i]);
+  }
+  for (size_t i = 0; i < kGauges; i++) {
+    Serial.printf("gauge %s %lu\n", kGaugeNames[i], (unsigned long)s.gauges[i]);
+  }
+  for (size_t h = 0; h < kHistograms; h++) {
+    const HistogramSnapshot& hs = s.histograms[h];
+    Serial.printf("hist %s count=%lu p50=%lu p90=%lu p99=%lu max=%lu\n", kHistogramNames[h],
+                  (unsigned long)hs.count, (unsigned long)hs.percentile(50),
+                  (unsigned long)hs.percentile(90), (unsigned long)hs.percentile(99),
+                  (unsigned long)hs.max);
+    if (hs.count == 0) continue;
+
+    char line[192];
+    int len = snprintf(line, sizeof(line), "buckets %s", kHistogramNames[h]);
+    for (size_t b = 0; b < kBuckets; b++) {
+      if (hs.buckets[b] == 0) continue;
+      if (len > static_cast<int>(sizeof(line)) - 24) {   // Línea llena: seguir en otra
+        Serial.printf("%s\n", line);
+        len = snprintf(line, sizeof(line), "buckets %s", kHistogramNames[h]);
+      }
+      len += snprintf(line + len, sizeof(line) - len, " %lu:%lu",
+                      (unsigned long)lowerBound(b), (unsigned long)hs.buckets[b]);
+    }
+    Serial.printf("%s\n", line);
+  }
+  Serial.printf("=== METRICS END ===\n");
+}
@@ -0,0 +1,155 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+#include "Config.hpp"
+#include "Types.hpp"
+
+// Métricas del ciclo de acceso: contadores, gauges e histogramas de
+// latencia, registrados en compilación (un enumerador y una fila de la
+// tabla de nombres por métrica, sin heap ni registro en runtime).
+//
+// Se actualizan con atómicos relaxed desde el paso de control y la tarea
+// de la barrera; snapshot() copia todo desde cualquier tarea o núcleo. Cada
+// valor es exacto por sí solo, pero la copia no es atómica en conjunto: un
+// histograma puede incluir una muestra que su contador todavía no.
+//
+// Histogramas estilo HDR con buckets fijos: los valores menores a 2^S ms
+// tienen bucket propio y cada octava siguiente se parte en 2^S buckets
+// (S = Cfg::kMetricsSubBucketBits), así el error relativo queda acotado en
+// todo el rango. Los percentiles salen de los buckets (cota superior del
+// bucket, nunca mayor que el máximo exacto).
+class Metrics {
+public:
+  enum class Counter : uint8_t {
+    ENTRY_VIP,          // Pedidos de entrada tomados de la cola, por clase
+    ENTRY_CARGA,
+    ENTRY_REGULAR,
+    EXITS,
+    DENIED_VIP,         // Entradas rechazadas sin capacidad, por clase
+    DENIED_CARGA,
+    DENIED_REGULAR,
+    OPEN_TIMEOUTS,      // AccessController::handleTimeout() por estado
+    CLOSE_TIMEOUTS,
+    FAULTS,             // Entradas a AccessState::FAULT
+    SAFETY_STOPS,       // Cierres revertidos por el sensor de seguridad
+    BARRIER_TIMEOUTS,   // Movimiento que no llegó a destino
+    kCount
+  };
+
+  enum class Gauge : uint8_t {
+    ACCESS_STATE,       // AccessState
+    BARRIER_STATE,      // BarrierState
+    QUEUE_DEPTH,
+    kCount
+  };
+
+  enum class Histogram : uint8_t {
+    OPEN_LATENCY,       // Pulsación -> barrera abierta (o turno encadenado)
+    CYCLE,              // Pedido tomado -> barrera cerrada
+    PASS_TIME,          // Barrera abierta -> paso detectado o kPassTimeMs
+    BARRIER_MOVE,       // Comando -> posición final (abrir y cerrar)
+    kCount
+  };
+
+  static constexpr size_t kCounters = static_cast<size_t>(Counter::kCount);
+  static constexpr size_t kGauges = static_cast<size_t>(Gauge::kCount);
+  static constexpr size_t kHistograms = static_cast<size_t>(Histogram::kCount);
+
+  static constexpr uint8_t kSubBits = Cfg::kMetricsSubBucketBits;
+  static constexpr uint32_t kSubBuckets = 1u << kSubBits;
+  static constexpr size_t kBuckets = kSubBuckets * (Cfg::kMetricsRangeBits - kSubBits + 1);
+  static_assert(Cfg::kMetricsRangeBits > kSubBits && Cfg::kMetricsRangeBits < 32,
+                "Metrics histogram range must exceed the sub-bucket bits");
+
+  // Contadores por VehicleClass (mismo orden que el enum)
+  static Counter entryOf(VehicleClass vc) {
+    return static_cast<Counter>(static_cast<uint8_t>(Counter::ENTRY_VIP) + static_cast<uint8_t>(vc));
+  }
+  static Counter deniedOf(VehicleClass vc) {
+    return static_cast<Counter>(static_cast<uint8_t>(Counter::DENIED_VIP) + static_cast<uint8_t>(vc));
+  }
+
+  // ---- Camino caliente ----
+
+  static void add(Counter c, uint32_t n = 1) {
+    counters_[static_cast<size_t>(c)].fetch_add(n, std::memory_order_relaxed);
+  }
+
+  static void set(Gauge g, uint32_t value) {
+    gauges_[static_cast<size_t>(g)].store(value, std::memory_order_relaxed);
+  }
+
+  static void record(Histogram h, uint32_t valueMs) {
+    Hist& hist = histograms_[static_cast<size_t>(h)];
+    hist.buckets[bucketOf(valueMs)].fetch_add(1, std::memory_order_relaxed);
+    hist.count.fetch_add(1, std::memory_order_relaxed);
+    uint32_t max = hist.max.load(std::memory_order_relaxed);
+    while (valueMs > max &&
+           !hist.max.compare_exchange_weak(max, valueMs, std::memory_order_relaxed)) {
+    }
+  }
+
+  // ---- Lectura ----
+
+  struct HistogramSnapshot {
+    uint32_t count;
+    uint32_t max;
+    uint32_t buckets[kBuckets];
+
+    // Valor en el percentil q (0-100); 0 sin muestras
+    uint32_t percentile(uint32_t q) const;
+  };
+
+  struct Snapshot {
+    uint32_t uptimeMs;
+    uint32_t counters[kCounters];
+    uint32_t gauges[kGauges];
+    HistogramSnapshot histograms[kHistograms];
+  };
+
+  static void snapshot(Snapshot& out);
+
+  // Volcado por Serial (comando 'M'): una línea por métrica y, por
+  // histograma, sus buckets no vacíos "<desde>:<cuenta>" para combinar
+  // snapshots en el host
+  static void dump();
+
+  static uint32_t get(Counter c) { return counters_[static_cast<size_t>(c)].load(std::memory_order_relaxed); }
+  static uint32_t get(Gauge g) { return gauges_[static_cast<size_t>(g)].load(std::memory_order_relaxed); }
+  static const char* name(Counter c);
+  static const char* name(Gauge g);
+  static const char* name(Histogram h);
+
+  // Bucket de un valor y rango [lowerBound, upperBound] de un bucket
+  static size_t bucketOf(uint32_t value) {
+    if (value < kSubBuckets) return value;
+    uint32_t msb = 31 - __builtin_clz(value);
+    if (msb >= Cfg::kMetricsRangeBits) return kBuckets - 1;
+    uint32_t shift = msb - kSubBits;
+    return (shift + 1) * kSubBuckets + ((value >> shift) - kSubBuckets);
+  }
+  static uint32_t lowerBound(size_t bucket) {
+    if (bucket < kSubBuckets) return static_cast<uint32_t>(bucket);
+    uint32_t shift = static_cast<uint32_t>(bucket / kSubBuckets) - 1;
+    return (kSubBuckets + bucket % kSubBuckets) << shift;
+  }
+  static uint32_t upperBound(size_t bucket) {
+    if (bucket < kSubBuckets) return static_cast<uint32_t>(bucket);
+    return lowerBound(bucket) + (1u << (bucket / kSubBuckets - 1)) - 1;
+  }
+
+private:
+  struct Hist {
+    std::atomic<uint32_t> count{0};
+    std::atomic<uint32_t> max{0};
+    std::atomic<uint32_t> buckets[kBuckets]{};
+  };
+
+  static SEMAFARO_TLS std::atomic<uint32_t> counters_[kCounters];
+  static SEMAFARO_TLS std::atomic<uint32_t> gauges_[kGauges];
+  static SEMAFARO_TLS Hist histograms_[kHistograms];
+
+public:
+  static constexpr size_t kFootprintBytes =
+      sizeof(counters_) + sizeof(gauges_) + sizeof(histograms_);
+};
@@ -0,0 +1,63 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <array>
+#include "Config.hpp"
+
+// Perfiles de movimiento normalizados, generados en compilación.
+// table[i] = posición (0..kScale) en t = i/N del movimiento; sample()
+// interpola por tiempo transcurrido, así un paso atrasado por jitter
+// cae en la posición correcta del perfil.
+namespace MotionProfile {
+  using Kind = Cfg::BarrierProfile;
+  constexpr uint16_t kScale = 65535;
+
+  // Fracción del tiempo en aceleración (y en frenado) del trapecio
+  constexpr double kTrapezoidAccel = 0.25;
+
+  // Posición normalizada en t ∈ [0,1]
+  constexpr double position(Kind kind, double t) {
+    switch (kind) {
+      case Kind::TRAPEZOID: {
+        // Aceleración constante, crucero, frenado simétrico
+        constexpr double a = kTrapezoidAccel;
+        constexpr double v = 1.0 / (1.0 - a);
+        if (t < a) return 0.5 * v / a * t * t;
+        if (t > 1.0 - a) return 1.0 - 0.5 * v / a * (1.0 - t) * (1.0 - t);
+        return 0.5 * v * a + v * (t - a);
+      }
+      case Kind::SCURVE:
+        // Mínimo jerk: velocidad y aceleración nulas en ambos extremos
+        return t * t * t * (10.0 + t * (-15.0 + 6.0 * t));
+      default:
+        return t;
+    }
+  }
+
+  // Velocidad pico relativa a la de un movimiento lineal de igual duración
+  constexpr double peakSpeedRatio(Kind kind) {
+    return kind == Kind::TRAPEZOID ? 1.0 / (1.0 - kTrapezoidAccel) :
+           kind == Kind::SCURVE ? 1.875 : 1.0;
+  }
+
+  template <size_t N>
+  constexpr std::array<uint16_t, N + 1> makeTable(Kind kind) {
+    std::array<uint16_t, N + 1> table{};
+    for (size_t i = 0; i <= N; i++) {
+      table[i] = static_cast<uint16_t>(position(kind, static_cast<double>(i) / N) * kScale + 0.5);
+    }
+    return table;
+  }
+
+  // Posición (0..kScale) a 'elapsedMs' de un movimiento de 'durationMs'
+  template <size_t N>
+  inline uint16_t sample(const std::array<uint16_t, N + 1>& table,
+                         uint32_t elapsedMs, uint32_t durationMs) {
+    if (elapsedMs >= durationMs) return kScale;
+    // Índice con 8 bits de fracción para interpolar entre muestras
+    uint32_t x = static_cast<uint32_t>(static_cast<uint64_t>(elapsedMs) * N * 256 / durationMs);
+    size_t i = x >> 8;
+    uint32_t frac = x & 0xFF;
+    return static_cast<uint16_t>(table[i] + (((table[i + 1] - table[i]) * frac) >> 8));
+  }
+}
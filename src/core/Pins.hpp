@@ -13,6 +13,7 @@ namespace Pins {
 
   // Sensor seguridad barrera
   constexpr uint8_t BARRIER_SAFE_IN = 10;
+  constexpr uint8_t PASS_LOOP_IN    = 4;   // Opcional: lazo después de la barrera (Cfg::kPassSensor)
 
   // Sensores de slots
   constexpr uint8_t S_VIP1  = 11;
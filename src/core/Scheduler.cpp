@@ -1,27 +1,326 @@
 #include "Scheduler.hpp"
+#include "Logger.hpp"
+#include "CycleCounter.hpp"
+#include <stdio.h>
 
-// Definición del vector estático
-std::vector<Scheduler::ScheduledTask> Scheduler::tasks_;
+// Definición de las tablas estáticas (.bss, sin heap)
+SEMAFARO_TLS std::array<Scheduler::ScheduledTask, Scheduler::kMaxTasks> Scheduler::tasks_{};
+SEMAFARO_TLS std::array<uint16_t, Scheduler::kMaxTasks> Scheduler::heap_{};
+SEMAFARO_TLS uint16_t Scheduler::heapSize_ = 0;
+SEMAFARO_TLS int16_t Scheduler::running_ = -1;
+SEMAFARO_TLS std::array<Scheduler::TaskStats, Scheduler::kMaxTasks> Scheduler::stats_{};
+SEMAFARO_TLS std::atomic<uint32_t> Scheduler::runSoon_{0};
+SEMAFARO_TLS TaskHandle_t Scheduler::loopTask_ = nullptr;
 
-void Scheduler::every(uint32_t intervalMs, Task task) {
-  tasks_.push_back({
-    .intervalMs = intervalMs,
-    .lastRunMs = millis(),
-    .task = task
-  });
+namespace {
+  // Comparación robusta ante el desborde de millis() (~49 días)
+  inline bool isDue(uint32_t nowMs, uint32_t dueMs) {
+    return static_cast<int32_t>(nowMs - dueMs) >= 0;
+  }
+
+  inline Scheduler::TaskId makeId(uint16_t idx, uint16_t generation) {
+    return (static_cast<uint32_t>(generation) << 16) | static_cast<uint32_t>(idx + 1);
+  }
+}
+
+Scheduler::TaskId Scheduler::add(uint32_t delayMs, uint32_t intervalMs, Task task, const char* name,
+                                 bool onDemand) {
+  // Buscar una entrada libre (ni activa ni en ejecución)
+  uint16_t idx = 0;
+  while (idx < kMaxTasks && (tasks_[idx].active || tasks_[idx].heapPos >= 0 || tasks_[idx].task)) idx++;
+  if (idx == kMaxTasks) {
+    LOG_ERR("Scheduler full (%u tasks) - task rejected", static_cast<unsigned>(kMaxTasks));
+    return kInvalidTask;
+  }
+
+  auto& t = tasks_[idx];
+  t.intervalMs = intervalMs;
+  t.nextRunMs = millis() + delayMs;
+  t.task = std::move(task);
+  t.generation++;
+  t.active = true;
+  t.onDemand = onDemand;
+  if (!onDemand) heapPush(idx);
+
+  stats_[idx] = TaskStats{};
+  stats_[idx].name = name;
+  stats_[idx].intervalMs = intervalMs;
+
+  return makeId(idx, t.generation);
+}
+
+Scheduler::ScheduledTask* Scheduler::find(TaskId id) {
+  uint16_t idx = static_cast<uint16_t>((id & 0xFFFF) - 1);
+  uint16_t generation = static_cast<uint16_t>(id >> 16);
+  if (id == kInvalidTask || idx >= tasks_.size()) return nullptr;
+
+  auto& t = tasks_[idx];
+  if (!t.active || t.generation != generation) return nullptr;
+  return &t;
+}
+
+bool Scheduler::runIn(TaskId id, uint32_t delayMs) {
+  ScheduledTask* t = find(id);
+  if (!t) return false;
+
+  t->nextRunMs = millis() + delayMs;
+  if (t->heapPos >= 0) {
+    int16_t pos = t->heapPos;
+    siftUp(pos);
+    siftDown(t->heapPos);
+  } else {
+    heapPush(static_cast<uint16_t>(t - tasks_.data()));
+  }
+  return true;
+}
+
+bool Scheduler::cancel(TaskId id) {
+  ScheduledTask* t = find(id);
+  if (!t) return false;
+
+  t->active = false;
+  if (t->heapPos >= 0) heapRemove(t->heapPos);
+  // Si está en ejecución, tick() lo libera al volver
+  if (running_ != t - tasks_.data()) t->task = nullptr;
+  return true;
+}
+
+void IRAM_ATTR Scheduler::runSoonFromIsr(TaskId id) {
+  uint16_t idx = static_cast<uint16_t>((id & 0xFFFF) - 1);
+  if (id == kInvalidTask || idx >= kMaxTasks) return;
+  runSoon_.fetch_or(1UL << idx, std::memory_order_relaxed);
+
+  TaskHandle_t task = loopTask_;
+  if (task) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(task, &woken);
+    portYIELD_FROM_ISR(woken);
+  }
+}
+
+void Scheduler::applyRunSoon(uint32_t nowMs) {
+  uint32_t mask = runSoon_.exchange(0, std::memory_order_relaxed);
+  while (mask) {
+    uint16_t idx = static_cast<uint16_t>(__builtin_ctz(mask));
+    mask &= mask - 1;
+
+    // Vence ahora; una tarea periódica retoma su periodo desde aquí
+    auto& t = tasks_[idx];
+    if (!t.active) continue;
+    if (t.heapPos < 0) {
+      t.nextRunMs = nowMs;   // A demanda sin armar
+      heapPush(idx);
+    } else if (!isDue(nowMs, t.nextRunMs)) {
+      t.nextRunMs = nowMs;
+      siftUp(t.heapPos);
+    }
+  }
 }
 
 void Scheduler::tick() {
   uint32_t now = millis();
-  
-  for (auto& scheduledTask : tasks_) {
-    if (now - scheduledTask.lastRunMs >= scheduledTask.intervalMs) {
-      scheduledTask.task();
-      scheduledTask.lastRunMs = now;
+  applyRunSoon(now);
+
+  while (heapSize_ > 0 && isDue(now, tasks_[heap_[0]].nextRunMs)) {
+    uint16_t idx = heapPop();
+    uint16_t generation = tasks_[idx].generation;
+    uint32_t jitterUs = micros() - tasks_[idx].nextRunMs * 1000;
+
+    // La tabla es fija: el callable se ejecuta en su lugar. Mientras corre,
+    // 'task' sigue ocupado y add() no puede reutilizar la entrada.
+    uint32_t startTicks = CycleCounter::now();
+    running_ = static_cast<int16_t>(idx);
+    tasks_[idx].task();
+    running_ = -1;
+    record(idx, CycleCounter::toUs(CycleCounter::now() - startTicks), jitterUs);
+
+    auto& t = tasks_[idx];
+    if (!t.active || t.generation != generation || (t.intervalMs == 0 && !t.onDemand)) {
+      // Cancelada durante su ejecución o de un solo disparo: liberar
+      t.active = false;
+      t.task = nullptr;
+      continue;
     }
+
+    // A demanda, o periódica reprogramada con runIn() durante su ejecución
+    if (t.intervalMs == 0 || t.heapPos >= 0) continue;
+
+    // Tasa fija: avanzar desde el vencimiento ideal. Si nos atrasamos más
+    // de un periodo, saltar los disparos perdidos manteniendo la fase.
+    t.nextRunMs += t.intervalMs;
+    if (isDue(now, t.nextRunMs)) {
+      uint32_t skipped = (now - t.nextRunMs) / t.intervalMs + 1;
+      t.nextRunMs += skipped * t.intervalMs;
+      stats_[idx].missed += skipped;
+    }
+    heapPush(idx);
   }
 }
 
+uint32_t Scheduler::msUntilNext() {
+  if (heapSize_ == 0) return Cfg::kMaxIdleSleepMs;
+
+  uint32_t now = millis();
+  uint32_t due = tasks_[heap_[0]].nextRunMs;
+  if (isDue(now, due)) return 0;
+  return min(due - now, Cfg::kMaxIdleSleepMs);
+}
+
+void Scheduler::sleepUntilNext() {
+  if (!loopTask_) loopTask_ = xTaskGetCurrentTaskHandle();
+  if (runSoon_.load(std::memory_order_relaxed)) return;
+
+  uint32_t waitMs = msUntilNext();
+  if (waitMs == 0) return;
+
+  // Un ISR que llame a runSoonFromIsr() corta la espera
+  ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(waitMs));
+}
+
 void Scheduler::clear() {
-  tasks_.clear();
-}
\ No newline at end of file
+  for (auto& t : tasks_) {
+    t.active = false;
+    t.onDemand = false;
+    t.heapPos = -1;
+    t.task = nullptr;
+  }
+  heapSize_ = 0;
+  runSoon_.store(0, std::memory_order_relaxed);
+}
+
+size_t Scheduler::taskCount() {
+  // Por la tabla y no por el heap: las on-demand sin armar y la tarea en
+  // curso (fuera del heap mientras corre) también ocupan un lugar
+  size_t count = 0;
+  for (const auto& t : tasks_) {
+    if (t.active) count++;
+  }
+  return count;
+}
+
+void Scheduler::printFootprint() {
+  LOG_INFO("Scheduler: %u/%u tasks, %u B per callable, %u B static",
+           static_cast<unsigned>(taskCount()), static_cast<unsigned>(kMaxTasks),
+           static_cast<unsigned>(Task::kCapacity), static_cast<unsigned>(kFootprintBytes));
+}
+
+// Instrumentación
+
+void Scheduler::record(uint16_t idx, uint32_t durationUs, uint32_t jitterUs) {
+  auto& st = stats_[idx];
+  st.runs++;
+  st.totalUs += durationUs;
+  if (durationUs < st.minUs) st.minUs = durationUs;
+  if (durationUs > st.maxUs) st.maxUs = durationUs;
+  st.totalJitterUs += jitterUs;
+  if (jitterUs > st.maxJitterUs) st.maxJitterUs = jitterUs;
+  if (st.intervalMs > 0 && durationUs >= st.intervalMs * 1000) st.overruns++;
+
+  uint32_t bucket = durationUs < 2 ? 0 : 31 - __builtin_clz(durationUs);
+  st.histogram[bucket < kHistBuckets ? bucket : kHistBuckets - 1]++;
+}
+
+const Scheduler::TaskStats* Scheduler::stats(TaskId id) {
+  uint16_t idx = static_cast<uint16_t>((id & 0xFFFF) - 1);
+  if (id == kInvalidTask || idx >= kMaxTasks) return nullptr;
+  if (tasks_[idx].generation != static_cast<uint16_t>(id >> 16)) return nullptr;
+  return &stats_[idx];
+}
+
+void Scheduler::printStats() {
+  LOG_INFO("=== SCHEDULER STATS ===");
+  for (size_t i = 0; i < kMaxTasks; i++) {
+    const auto& st = stats_[i];
+    if (!tasks_[i].active || st.runs == 0) continue;
+
+    LOG_INFO("Task %s (%lu ms): runs=%lu dur min/avg/max=%lu/%lu/%lu us "
+             "jitter avg/max=%lu/%lu us overruns=%lu missed=%lu",
+             st.name, (unsigned long)st.intervalMs, (unsigned long)st.runs,
+             (unsigned long)st.minUs, (unsigned long)(st.totalUs / st.runs),
+             (unsigned long)st.maxUs, (unsigned long)(st.totalJitterUs / st.runs),
+             (unsigned long)st.maxJitterUs, (unsigned long)st.overruns,
+             (unsigned long)st.missed);
+
+    // Histograma log2: sólo buckets no vacíos, "<N" en µs
+    char line[160];
+    int len = 0;
+    for (size_t b = 0; b < kHistBuckets && len < static_cast<int>(sizeof(line)); b++) {
+      if (st.histogram[b] == 0) continue;
+      len += snprintf(line + len, sizeof(line) - len, " %s%lu:%lu",
+                      b == kHistBuckets - 1 ? ">=" : "<",
+                      b == kHistBuckets - 1 ? 1UL << b : 2UL << b,
+                      (unsigned long)st.histogram[b]);
+    }
+    LOG_INFO("  hist[us]:%s", line);
+  }
+}
+
+void Scheduler::resetStats() {
+  for (size_t i = 0; i < kMaxTasks; i++) {
+    const char* name = stats_[i].name;
+    uint32_t intervalMs = stats_[i].intervalMs;
+    stats_[i] = TaskStats{};
+    stats_[i].name = name;
+    stats_[i].intervalMs = intervalMs;
+  }
+}
+
+// Min-heap sobre tasks_[].nextRunMs
+
+bool Scheduler::before(uint16_t a, uint16_t b) {
+  return static_cast<int32_t>(tasks_[a].nextRunMs - tasks_[b].nextRunMs) < 0;
+}
+
+void Scheduler::heapSet(int16_t pos, uint16_t idx) {
+  heap_[pos] = idx;
+  tasks_[idx].heapPos = pos;
+}
+
+void Scheduler::heapPush(uint16_t idx) {
+  int16_t pos = static_cast<int16_t>(heapSize_++);
+  heapSet(pos, idx);
+  siftUp(pos);
+}
+
+uint16_t Scheduler::heapPop() {
+  uint16_t top = heap_[0];
+  heapRemove(0);
+  return top;
+}
+
+void Scheduler::heapRemove(int16_t pos) {
+  uint16_t removed = heap_[pos];
+  uint16_t last = heap_[--heapSize_];
+  tasks_[removed].heapPos = -1;
+
+  if (pos < static_cast<int16_t>(heapSize_)) {
+    heapSet(pos, last);
+    siftUp(pos);
+    siftDown(tasks_[last].heapPos);
+  }
+}
+
+void Scheduler::siftUp(int16_t pos) {
+  uint16_t idx = heap_[pos];
+  while (pos > 0) {
+    int16_t parent = (pos - 1) / 2;
+    if (!before(idx, heap_[parent])) break;
+    heapSet(pos, heap_[parent]);
+    pos = parent;
+  }
+  heapSet(pos, idx);
+}
+
+void Scheduler::siftDown(int16_t pos) {
+  uint16_t idx = heap_[pos];
+  int16_t size = static_cast<int16_t>(heapSize_);
+  while (true) {
+    int16_t child = 2 * pos + 1;
+    if (child >= size) break;
+    if (child + 1 < size && before(heap_[child + 1], heap_[child])) child++;
+    if (!before(heap_[child], idx)) break;
+    heapSet(pos, heap_[child]);
+    pos = child;
+  }
+  heapSet(pos, idx);
+}
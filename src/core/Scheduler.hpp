@@ -1,27 +1,129 @@
 #pragma once
 #include <Arduino.h>
-#include <functional>
-#include <vector>
+#include <array>
+#include <atomic>
+#include <utility>
+#include "Config.hpp"
+#include "InlineFunction.hpp"
 
+// Scheduler cooperativo ordenado por deadline.
+// Las tareas viven en un min-heap indexado por su próximo vencimiento, así
+// tick() sólo toca las tareas vencidas y msUntilNext() es O(1).
+// Tabla de capacidad fija y callables inline: cero heap después de setup().
 class Scheduler {
 public:
-  using Task = std::function<void()>;
-  
-  // Programar una tarea para ejecutar cada 'intervalMs' milisegundos
-  static void every(uint32_t intervalMs, Task task);
-  
-  // Ejecutar todas las tareas pendientes (llamar en loop())
+  using Task = InlineFunction<Cfg::kTaskStorageBytes>;
+  using TaskId = uint32_t;
+  static constexpr TaskId kInvalidTask = 0;
+  static constexpr size_t kMaxTasks = Cfg::kMaxTasks;
+
+  // Programar una tarea para ejecutar cada 'intervalMs' milisegundos.
+  // Tasa fija: el siguiente vencimiento es el ideal + intervalo (no deriva).
+  // El tamaño del callable se verifica en compilación; kInvalidTask si la tabla está llena.
+  template <typename F>
+  static TaskId every(uint32_t intervalMs, F&& fn, const char* name = "task") {
+    if (intervalMs == 0) intervalMs = 1;
+    return add(intervalMs, intervalMs, Task(std::forward<F>(fn)), name);
+  }
+
+  // Programar una tarea de un solo disparo dentro de 'delayMs'
+  template <typename F>
+  static TaskId after(uint32_t delayMs, F&& fn, const char* name = "once") {
+    return add(delayMs, 0, Task(std::forward<F>(fn)), name);
+  }
+
+  // Registrar una tarea a demanda: no vence sola, corre cuando se la arma
+  // con runIn() o runSoonFromIsr(), y después queda registrada sin vencimiento
+  template <typename F>
+  static TaskId onDemand(F&& fn, const char* name = "ondemand") {
+    return add(0, 0, Task(std::forward<F>(fn)), name, true);
+  }
+
+  // (Re)programar el próximo vencimiento de una tarea dentro de 'delayMs'
+  // (también desde dentro de la propia tarea). Una periódica sigue su
+  // periodo a partir de ahí.
+  static bool runIn(TaskId id, uint32_t delayMs);
+
+  // Cancelar una tarea (también desde dentro de la propia tarea)
+  static bool cancel(TaskId id);
+
+  // Desde un ISR: adelantar la tarea para que corra en el próximo tick()
+  // y despertar a loop() si está dormido en sleepUntilNext()
+  static void runSoonFromIsr(TaskId id);
+
+  // Ejecutar todas las tareas vencidas (llamar en loop())
   static void tick();
-  
+
+  // Milisegundos hasta el próximo vencimiento (0 si ya hay una vencida)
+  static uint32_t msUntilNext();
+
+  // Dormir hasta el próximo vencimiento o hasta un runSoonFromIsr():
+  // notificación de tarea FreeRTOS (reloj virtual en el build nativo)
+  static void sleepUntilNext();
+
   // Limpiar todas las tareas programadas
   static void clear();
 
+  // Tareas activas y huella estática (conocida en tiempo de enlace)
+  static size_t taskCount();
+  static void printFootprint();
+
+  // Instrumentación por tarea (duración, jitter de arranque, overruns)
+  static constexpr size_t kHistBuckets = 16;   // log2(µs): [<2, <4, ..., >=32768]
+  struct TaskStats {
+    const char* name{nullptr};
+    uint32_t intervalMs{0};
+    uint32_t runs{0};
+    uint32_t minUs{UINT32_MAX};
+    uint32_t maxUs{0};
+    uint64_t totalUs{0};
+    uint32_t maxJitterUs{0};     // Arranque real - deadline ideal
+    uint64_t totalJitterUs{0};
+    uint32_t overruns{0};        // Ejecuciones más largas que su periodo
+    uint32_t missed{0};          // Periodos saltados por atraso
+    uint32_t histogram[kHistBuckets]{};
+  };
+
+  static const TaskStats* stats(TaskId id);
+  static void printStats();
+  static void resetStats();
+
 private:
   struct ScheduledTask {
-    uint32_t intervalMs;
-    uint32_t lastRunMs;
+    uint32_t intervalMs{0};   // 0 para tareas de un solo disparo
+    uint32_t nextRunMs{0};
     Task task;
+    uint16_t generation{0};   // Invalida TaskId viejos al reutilizar la entrada
+    int16_t heapPos{-1};      // -1 si no está en el heap
+    bool active{false};
+    bool onDemand{false};     // Sin periodo, pero no se libera al terminar
   };
-  
-  static std::vector<ScheduledTask> tasks_;
-};
\ No newline at end of file
+
+  static TaskId add(uint32_t delayMs, uint32_t intervalMs, Task task, const char* name,
+                    bool onDemand = false);
+  static ScheduledTask* find(TaskId id);
+  static void applyRunSoon(uint32_t nowMs);
+  static void record(uint16_t idx, uint32_t durationUs, uint32_t jitterUs);
+  static bool before(uint16_t a, uint16_t b);
+  static void heapPush(uint16_t idx);
+  static uint16_t heapPop();
+  static void heapRemove(int16_t pos);
+  static void siftUp(int16_t pos);
+  static void siftDown(int16_t pos);
+  static void heapSet(int16_t pos, uint16_t idx);
+
+  static SEMAFARO_TLS std::array<ScheduledTask, kMaxTasks> tasks_;
+  static SEMAFARO_TLS std::array<uint16_t, kMaxTasks> heap_;   // Índices en tasks_ ordenados por nextRunMs
+  static SEMAFARO_TLS uint16_t heapSize_;
+  static SEMAFARO_TLS int16_t running_;                 // Índice en ejecución, -1 fuera de tick()
+  static SEMAFARO_TLS std::array<TaskStats, kMaxTasks> stats_;
+  static SEMAFARO_TLS std::atomic<uint32_t> runSoon_;   // Bit i: tasks_[i] adelantada desde un ISR
+  static SEMAFARO_TLS TaskHandle_t loopTask_;           // Tarea dormida en sleepUntilNext()
+  static_assert(kMaxTasks <= 32, "runSoon_ mask holds at most 32 tasks");
+
+public:
+  static constexpr size_t kFootprintBytes =
+      sizeof(tasks_) + sizeof(heap_) + sizeof(heapSize_) + sizeof(running_) + sizeof(stats_);
+  static_assert(kFootprintBytes <= Cfg::kSchedulerBudgetBytes,
+                "Scheduler footprint exceeds Cfg::kSchedulerBudgetBytes");
+};
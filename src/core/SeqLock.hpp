@@ -0,0 +1,57 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+// Valor compartido con un escritor y lectores en cualquier tarea o núcleo,
+// sin locks. El escritor incrementa la secuencia a impar, copia y la deja
+// par; el lector copia y reintenta si la secuencia era impar o cambió.
+// Leer nunca bloquea al escritor y cuesta una copia de T.
+//
+// Los datos van en palabras atómicas (relaxed) en lugar de un T plano:
+// la copia concurrente con una escritura no es una carrera de datos,
+// sólo una copia que el lector descarta.
+template <typename T>
+class SeqLock {
+  static_assert(std::is_trivially_copyable<T>::value, "SeqLock needs a trivially copyable type");
+
+public:
+  // Sólo el escritor (una tarea)
+  void write(const T& value) {
+    uint32_t buf[kWords] = {};
+    memcpy(buf, &value, sizeof(T));
+
+    uint32_t seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    for (size_t i = 0; i < kWords; i++) words_[i].store(buf[i], std::memory_order_relaxed);
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  // Cualquier tarea/núcleo. Reintenta mientras haya una escritura en curso
+  T read() const {
+    uint32_t buf[kWords];
+    uint32_t before, after;
+    do {
+      before = seq_.load(std::memory_order_acquire);
+      for (size_t i = 0; i < kWords; i++) buf[i] = words_[i].load(std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = seq_.load(std::memory_order_relaxed);
+    } while ((before & 1) || before != after);
+
+    T value;
+    memcpy(&value, buf, sizeof(T));
+    return value;
+  }
+
+  // Escrituras completas desde el arranque (seq / 2)
+  uint32_t version() const { return seq_.load(std::memory_order_acquire) / 2; }
+
+private:
+  static constexpr size_t kWords = (sizeof(T) + 3) / 4;
+
+  std::atomic<uint32_t> seq_{0};
+  std::atomic<uint32_t> words_[kWords]{};
+};
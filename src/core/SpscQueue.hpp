@@ -0,0 +1,43 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+// Cola lock-free de un productor y un consumidor, capacidad fija (potencia
+// de 2). push() y pop() son wait-free: un par de loads/stores atómicos y
+// una copia, aptos para un ISR. Si está llena, push() descarta y retorna false.
+template <typename T, size_t Capacity>
+class SpscQueue {
+  static_assert((Capacity & (Capacity - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+public:
+  static constexpr size_t kCapacity = Capacity;
+
+  // Sólo el productor
+  bool push(const T& item) {
+    uint32_t head = head_.load(std::memory_order_relaxed);
+    if (head - tail_.load(std::memory_order_acquire) == Capacity) return false;
+    items_[head & (Capacity - 1)] = item;
+    head_.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+  // Sólo el consumidor
+  bool pop(T& item) {
+    uint32_t tail = tail_.load(std::memory_order_relaxed);
+    if (tail == head_.load(std::memory_order_acquire)) return false;
+    item = items_[tail & (Capacity - 1)];
+    tail_.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    return head_.load(std::memory_order_acquire) - tail_.load(std::memory_order_acquire);
+  }
+  bool empty() const { return size() == 0; }
+
+private:
+  T items_[Capacity];
+  std::atomic<uint32_t> head_{0};   // Escrito por el productor
+  std::atomic<uint32_t> tail_{0};   // Escrito por el consumidor
+};
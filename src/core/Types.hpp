@@ -2,6 +2,9 @@
 #include <stdint.h>
 
 // Tipos comunes para el proyecto SEMAFARO
+
+// msUntilNext() de dispositivos y lógica: nada pendiente por tiempo
+constexpr uint32_t kNoDeadline = UINT32_MAX;
 enum class VehicleClass : uint8_t { 
   VIP, 
   CARGA, 
@@ -16,7 +19,8 @@ enum class SlotType : uint8_t {
 
 enum class SlotState : uint8_t { 
   FREE, 
-  OCCUPIED 
+  OCCUPIED,
+  RESERVED   // Asignado a un vehículo que todavía no llegó al slot
 };
 
 // Estados de la barrera
@@ -28,6 +32,16 @@ enum class BarrierState : uint8_t {
   FAULT
 };
 
+// Estados de la FSM de acceso (AccessController::State)
+enum class AccessState : uint8_t {
+  IDLE,
+  CHECK_CAPACITY,
+  OPENING,
+  WAIT_PASS,
+  CLOSING,
+  FAULT
+};
+
 // Eventos del sistema
 enum class SystemEvent : uint8_t {
   BTN_VIP_PRESSED,
@@ -0,0 +1,70 @@
+#pragma once
+#include <stdint.h>
+#include <type_traits>
+
+// Debounce bit-paralelo con contadores verticales: cada bit de 'Word' es una
+// entrada independiente y el contador de cada una está repartido en 'Bits'
+// palabras (plano b = bit b del contador). Un cambio se acepta tras
+// 2^Bits muestras consecutivas distintas del estado estable; cualquier
+// muestra igual reinicia el contador de esa entrada.
+//
+// Costo por muestra: unas pocas operaciones bit a bit por plano, igual para
+// 1 o 64 entradas. Sin timestamps por entrada.
+template <typename Word, uint8_t Bits>
+class VerticalDebouncer {
+  static_assert(std::is_unsigned<Word>::value, "VerticalDebouncer needs an unsigned word");
+  static_assert(Bits >= 1 && Bits <= 8, "VerticalDebouncer supports 1..8 counter bits");
+
+public:
+  static constexpr uint32_t kSamplesToAccept = 1u << Bits;
+
+  // Fijar el estado estable sin generar flancos (arranque)
+  void reset(Word state) {
+    state_ = state;
+    rising_ = 0;
+    falling_ = 0;
+    for (auto& plane : count_) plane = 0;
+  }
+
+  // Procesar una muestra; retorna la máscara de entradas que cambiaron
+  Word update(Word sample) {
+    Word delta = sample ^ state_;
+
+    // Incremento vertical donde la muestra difiere; el acarreo final
+    // (desborde) marca las entradas que llegaron a 2^Bits
+    Word carry = delta;
+    for (uint8_t b = 0; b < Bits; b++) {
+      Word next = count_[b] & carry;
+      count_[b] = (count_[b] ^ carry) & delta;   // Reinicio donde coincide
+      carry = next;
+    }
+
+    state_ ^= carry;
+    rising_ |= carry & state_;
+    falling_ |= carry & ~state_;
+    return carry;
+  }
+
+  // Aceptar cambios decididos fuera del contador (p.ej. por tiempo exacto):
+  // invierte el estado de 'mask', latchea sus flancos y reinicia sus contadores
+  void toggle(Word mask) {
+    state_ ^= mask;
+    rising_ |= mask & state_;
+    falling_ |= mask & ~state_;
+    for (auto& plane : count_) plane &= ~mask;
+  }
+
+  Word state() const { return state_; }
+
+  // Flancos latcheados desde la última lectura; takeX() los consume
+  Word rising() const { return rising_; }
+  Word falling() const { return falling_; }
+  Word takeRising(Word mask) { Word r = rising_ & mask; rising_ &= ~mask; return r; }
+  Word takeFalling(Word mask) { Word f = falling_ & mask; falling_ &= ~mask; return f; }
+
+private:
+  Word state_{0};
+  Word rising_{0};
+  Word falling_{0};
+  Word count_[Bits]{};
+};
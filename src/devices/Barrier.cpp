@@ -1,50 +1,60 @@
 #include "Barrier.hpp"
 #include "core/Logger.hpp"
+#include "core/Metrics.hpp"
+#include "app/AppBus.hpp"
 
-void Barrier::begin(uint8_t pwmPin) {
+void Barrier::begin(uint8_t pwmPin, const ProximitySensor* safeSensor) {
   pin_ = pwmPin;
-  
-  // Configurar servo
-  servo_.attach(pin_);
-  
+  safe_ = safeSensor;
+
+  // Configurar servo (rango de pulso explícito: degToUs() usa el mismo)
+  drive_.attach(pin_, Cfg::kServoMinUs, Cfg::kServoMaxUs);
+
   // Posición inicial cerrada
-  currentAngle_ = closedAngle_;
-  targetAngle_ = closedAngle_;
-  servo_.write(currentAngle_);
-  
+  currentUs_ = closedUs_;
+  drive_.write(currentUs_);
+
   state_ = BarrierState::CLOSED;
-  lastLoggedState_ = state_;
   commandStartMs_ = millis();
-  lastStepMs_ = millis();
-  
-  LOG_INFO("Barrier initialized on pin %d (closed: %d°, open: %d°)", 
-           pin_, closedAngle_, openAngle_);
+
+  // Se arma con open()/close() y se re-arma sola mientras haya movimiento
+  // (con fade por hardware, también desde la interrupción de fin de tramo)
+  motionTask_ = Scheduler::onDemand([this]() { motionStep(millis()); }, "barrier");
+  drive_.setRampDoneTask(motionTask_);
+
+  LOG_INFO("Barrier initialized on pin %d (closed: %d°, open: %d°)",
+           pin_, usToDeg(closedUs_), usToDeg(openUs_));
 }
 
 void Barrier::setAngles(uint8_t closedDeg, uint8_t openDeg) {
-  closedAngle_ = closedDeg;
-  openAngle_ = openDeg;
-  
+  closedUs_ = degToUs(closedDeg);
+  openUs_ = degToUs(openDeg);
+
   // Si estamos cerrados, actualizar posición actual
   if (state_ == BarrierState::CLOSED) {
-    currentAngle_ = closedAngle_;
-    targetAngle_ = closedAngle_;
-    servo_.write(currentAngle_);
+    currentUs_ = closedUs_;
+    drive_.write(currentUs_);
   }
-  
+
   LOG_INFO("Barrier angles updated (closed: %d°, open: %d°)", closedDeg, openDeg);
 }
 
+void Barrier::setTiming(const Cfg::GateTiming& timing) {
+  // Aplica desde el próximo movimiento
+  moveMs_ = timing.moveMs;
+  openTimeoutMs_ = timing.openTimeoutMs;
+  closeTimeoutMs_ = timing.closeTimeoutMs;
+}
+
 void Barrier::open() {
   if (state_ == BarrierState::FAULT) {
     LOG_WARN("Cannot open barrier - in FAULT state");
     return;
   }
-  
+
   if (state_ != BarrierState::OPEN && state_ != BarrierState::OPENING) {
-    targetAngle_ = openAngle_;
-    commandStartMs_ = millis();
     setState(BarrierState::OPENING);
+    startMove(openUs_);
     LOG_INFO("Barrier opening command issued");
   }
 }
@@ -54,92 +64,159 @@ void Barrier::close() {
     LOG_WARN("Cannot close barrier - in FAULT state");
     return;
   }
-  
+
   if (state_ != BarrierState::CLOSED && state_ != BarrierState::CLOSING) {
-    targetAngle_ = closedAngle_;
-    commandStartMs_ = millis();
     setState(BarrierState::CLOSING);
+    startMove(closedUs_);
     LOG_INFO("Barrier closing command issued");
   }
 }
 
 void Barrier::stop() {
-  targetAngle_ = currentAngle_;
-  
   if (isMoving()) {
+    // La posición real: con fade por hardware, la del registro de duty
+    drive_.hold();
+    currentUs_ = drive_.read();
+
     // Determinar estado final basado en posición
-    if (abs(currentAngle_ - openAngle_) < abs(currentAngle_ - closedAngle_)) {
+    if (abs(currentUs_ - openUs_) < abs(currentUs_ - closedUs_)) {
       setState(BarrierState::OPEN);
     } else {
       setState(BarrierState::CLOSED);
     }
-    LOG_INFO("Barrier stopped at %d°", currentAngle_);
+    LOG_INFO("Barrier stopped at %d°", usToDeg(currentUs_));
   }
 }
 
-void Barrier::update(uint32_t nowMs, bool safeSensorActive) {
-  // Si el sensor de seguridad está activo y estamos cerrando, detener
-  if (safeSensorActive && state_ == BarrierState::CLOSING) {
-    LOG_WARN("Safety sensor active - stopping barrier closure");
-    stop();
-    return;
+void Barrier::checkSafety() {
+  // Si el sensor de seguridad está activo y estamos cerrando, volver a
+  // abrir desde la posición actual. Detenerla a mitad de camino la dejaría
+  // sobre el vehículo, y stop() la daría por CLOSED en la mitad inferior
+  if (safe_ && safe_->isDetected() && state_ == BarrierState::CLOSING) {
+    LOG_WARN("Safety sensor active - reopening barrier");
+    Metrics::add(Metrics::Counter::SAFETY_STOPS);
+    open();
   }
-  
+}
+
+void Barrier::printStats() const {
+  LOG_INFO("Barrier motion: open %lu ms, close %lu ms (nominal %lu ms, %lu ms/step)",
+           lastOpenMs_, lastCloseMs_, nominalMoveMs(), stepIntervalMs_);
+}
+
+void Barrier::startMove(uint16_t targetUs) {
+  // Desde la posición actual (también a mitad de un movimiento): la
+  // duración escala con el recorrido, así la velocidad pico no cambia
+  drive_.hold();
+  currentUs_ = drive_.read();
+  uint32_t range = abs(openUs_ - closedUs_);
+  uint32_t distance = abs(targetUs - currentUs_);
+  fromUs_ = currentUs_;
+  toUs_ = targetUs;
+  moveDurationMs_ = range ? max<uint32_t>(moveMs_ * distance / range, stepIntervalMs_)
+                          : stepIntervalMs_;
+  commandStartMs_ = millis();
+  commandStartUs_ = micros();
+  segment_ = 0;
+
+  // Primer paso ya: si la tarea estaba armada, se reprograma
+  Scheduler::runIn(motionTask_, 0);
+}
+
+void Barrier::motionStep(uint32_t nowMs) {
+  checkSafety();
+
   // Verificar timeouts
   uint32_t elapsed = nowMs - commandStartMs_;
-  if (state_ == BarrierState::OPENING && elapsed > openTimeoutMs_) {
-    LOG_ERR("Barrier open timeout (%lu ms)", elapsed);
+  if ((state_ == BarrierState::OPENING && elapsed > openTimeoutMs_) ||
+      (state_ == BarrierState::CLOSING && elapsed > closeTimeoutMs_)) {
+    AppBus::publish(Events::BarrierTimeout{state_, nowMs});
+    Metrics::add(Metrics::Counter::BARRIER_TIMEOUTS);
     setState(BarrierState::FAULT);
     return;
   }
-  
-  if (state_ == BarrierState::CLOSING && elapsed > closeTimeoutMs_) {
-    LOG_ERR("Barrier close timeout (%lu ms)", elapsed);
-    setState(BarrierState::FAULT);
+
+  if (!isMoving()) return;   // stop() o comando ya resuelto: la tarea queda sin armar
+
+  if (BarrierDrive::kHardwareRamp) {
+    rampStep(elapsed);
     return;
   }
-  
-  // Movimiento suave paso a paso
-  if (isMoving() && (nowMs - lastStepMs_) >= stepIntervalMs_) {
-    lastStepMs_ = nowMs;
-    
-    if (currentAngle_ != targetAngle_) {
-      // Calcular siguiente paso
-      if (currentAngle_ < targetAngle_) {
-        currentAngle_ = min(static_cast<uint8_t>(currentAngle_ + Cfg::kServoStepDeg), targetAngle_);
-      } else {
-        currentAngle_ = max(static_cast<uint8_t>(currentAngle_ - Cfg::kServoStepDeg), targetAngle_);
-      }
-      
-      // Aplicar posición
-      servo_.write(currentAngle_);
-      
-      // Verificar si llegamos al destino
-      if (hasReachedTarget()) {
-        if (state_ == BarrierState::OPENING) {
-          setState(BarrierState::OPEN);
-          LOG_INFO("Barrier fully opened");
-        } else if (state_ == BarrierState::CLOSING) {
-          setState(BarrierState::CLOSED);
-          LOG_INFO("Barrier fully closed");
-        }
-      }
-    }
+
+  // Posición del perfil según el tiempo transcurrido (no según pasos dados)
+  uint16_t us = profileUs(elapsed);
+  if (us != currentUs_) {
+    currentUs_ = us;
+    drive_.write(currentUs_);
+  }
+
+  // Verificar si llegamos al destino
+  if (elapsed >= moveDurationMs_) {
+    finishMove(elapsed);
+    return;
+  }
+
+  // Próximo paso, sin pasarse del final del perfil
+  Scheduler::runIn(motionTask_, min(stepIntervalMs_, moveDurationMs_ - elapsed));
+}
+
+void Barrier::rampStep(uint32_t elapsed) {
+  // Tramo en curso: la interrupción de fin de fade vuelve a armar la tarea
+  if (!drive_.rampDone()) {
+    Scheduler::runIn(motionTask_, stepIntervalMs_);
+    return;
+  }
+
+  currentUs_ = drive_.read();
+  if (segment_ >= Cfg::kBarrierFadeSegments) {
+    finishMove(elapsed);
+    return;
+  }
+
+  // Próximo tramo: recta hasta el siguiente punto del perfil. La duración
+  // se mide desde 'elapsed', así un fin de tramo atendido tarde no atrasa el resto
+  segment_++;
+  uint32_t segEndMs = moveDurationMs_ * segment_ / Cfg::kBarrierFadeSegments;
+  uint32_t fadeMs = segEndMs > elapsed ? segEndMs - elapsed : 1;
+  drive_.rampTo(profileUs(segEndMs), fadeMs);
+
+  // Respaldo por si la interrupción no llega (los timeouts siguen vigentes)
+  Scheduler::runIn(motionTask_, fadeMs + stepIntervalMs_);
+}
+
+void Barrier::finishMove(uint32_t elapsed) {
+  Metrics::record(Metrics::Histogram::BARRIER_MOVE, elapsed);
+  if (state_ == BarrierState::OPENING) {
+    lastOpenMs_ = elapsed;
+    setState(BarrierState::OPEN);
+  } else if (state_ == BarrierState::CLOSING) {
+    lastCloseMs_ = elapsed;
+    setState(BarrierState::CLOSED);
   }
 }
 
+uint16_t Barrier::profileUs(uint32_t elapsed) const {
+  uint32_t progress = MotionProfile::sample<Cfg::kProfileSamples>(kProfile, elapsed, moveDurationMs_);
+  int32_t delta = static_cast<int32_t>(toUs_) - fromUs_;
+  return static_cast<uint16_t>(fromUs_ + delta * static_cast<int32_t>(progress) / MotionProfile::kScale);
+}
+
 void Barrier::setState(BarrierState newState) {
   if (state_ != newState) {
     state_ = newState;
-    
-    // Log solo cambios de estado
-    if (lastLoggedState_ != newState) {
-      LOG_DEBUG("Barrier state: %d -> %d", (int)lastLoggedState_, (int)newState);
-      lastLoggedState_ = newState;
+    Metrics::set(Metrics::Gauge::BARRIER_STATE, static_cast<uint32_t>(newState));
+
+    // Posición final o falla: que la FSM lo vea sin esperar su próximo paso
+    if (newState != BarrierState::OPENING && newState != BarrierState::CLOSING &&
+        consumer_ != Scheduler::kInvalidTask) {
+      Scheduler::runIn(consumer_, 0);
+    }
+
+    // Publicar llegadas a posición final (el log lo hace EventLog)
+    if (newState == BarrierState::OPEN) {
+      AppBus::publish(Events::BarrierOpened{millis()});
+    } else if (newState == BarrierState::CLOSED) {
+      AppBus::publish(Events::BarrierClosed{millis()});
     }
   }
 }
-
-bool Barrier::hasReachedTarget() const {
-  return currentAngle_ == targetAngle_;
-}
\ No newline at end of file
@@ -1,58 +1,111 @@
 #pragma once
 #include <Arduino.h>
-#include <ESP32Servo.h>
 #include "core/Config.hpp"
 #include "core/Types.hpp"
+#include "core/Scheduler.hpp"
+#include "core/MotionProfile.hpp"
+#include "devices/ProximitySensor.hpp"
+#include "devices/ServoDrive.hpp"
 
+// Barrera con su propia tarea de movimiento ("barrier"): mientras se mueve
+// corre cada Cfg::kBarrierStepMs, independiente del paso de control, y
+// aplica el sensor de seguridad y los timeouts. La FSM sólo ordena
+// open()/close() y observa el estado.
+//
+// La posición sigue un perfil (Cfg::kBarrierProfile) precalculado en
+// compilación y se escribe al servo en µs, no en grados enteros. Con
+// BARRIER_DRIVE_LEDC_FADE el perfil va en Cfg::kBarrierFadeSegments tramos
+// de fade por hardware y la tarea sólo corre al terminar cada tramo.
 class Barrier {
 public:
-  void begin(uint8_t pwmPin);
+  void begin(uint8_t pwmPin, const ProximitySensor* safeSensor = nullptr);
   void setAngles(uint8_t closedDeg, uint8_t openDeg);
-  
+
   // Comandos no bloqueantes
   void open();
   void close();
   void stop(); // Detener movimiento inmediatamente
-  
-  // Update no bloqueante - debe llamarse periódicamente
-  void update(uint32_t nowMs, bool safeSensorActive);
-  
+
+  // Revertir ya un cierre si el sensor de seguridad está activo: vuelve a
+  // abrir desde donde esté (la tarea de movimiento lo verifica en cada paso;
+  // el paso de control, con cada muestreo)
+  void checkSafety();
+
+  // Recorrido y timeouts (por defecto los de Cfg)
+  void setTiming(const Cfg::GateTiming& timing);
+
+  // Tarea a despertar al llegar a OPEN/CLOSED/FAULT (kInvalidTask: nadie)
+  void setConsumer(Scheduler::TaskId id) { consumer_ = id; }
+
+  // Tiempos del último movimiento completo (comando -> posición final) y
+  // el nominal del perfil (Cfg::kBarrierMoveMs o setTiming())
+  uint32_t lastOpenMs() const { return lastOpenMs_; }
+  uint32_t lastCloseMs() const { return lastCloseMs_; }
+  uint32_t nominalMoveMs() const { return moveMs_; }
+  // Instante (micros) del último open()/close() que arrancó un movimiento
+  uint32_t lastCommandUs() const { return commandStartUs_; }
+  void printStats() const;
+
   // Estado actual
   BarrierState getState() const { return state_; }
   bool isMoving() const { return state_ == BarrierState::OPENING || state_ == BarrierState::CLOSING; }
   bool isOpen() const { return state_ == BarrierState::OPEN; }
   bool isClosed() const { return state_ == BarrierState::CLOSED; }
   bool isFault() const { return state_ == BarrierState::FAULT; }
-  
+
   // Para debugging
-  uint8_t getCurrentAngle() const { return currentAngle_; }
+  uint8_t getCurrentAngle() const { return usToDeg(currentUs_); }
+  uint16_t getCurrentUs() const { return currentUs_; }
 
 private:
-  void moveTo(uint8_t targetAngle);
+  static constexpr auto kProfile =
+      MotionProfile::makeTable<Cfg::kProfileSamples>(Cfg::kBarrierProfile);
+
+  // Mismo mapeo que attach(pin, kServoMinUs, kServoMaxUs) para 0-180°
+  static constexpr uint16_t degToUs(uint8_t deg) {
+    return Cfg::kServoMinUs + static_cast<uint32_t>(Cfg::kServoMaxUs - Cfg::kServoMinUs) * deg / 180;
+  }
+  static constexpr uint8_t usToDeg(uint16_t us) {
+    return us <= Cfg::kServoMinUs ? 0 :
+           static_cast<uint8_t>((static_cast<uint32_t>(us - Cfg::kServoMinUs) * 180 +
+                                 (Cfg::kServoMaxUs - Cfg::kServoMinUs) / 2) /
+                                (Cfg::kServoMaxUs - Cfg::kServoMinUs));
+  }
+
+  void startMove(uint16_t targetUs);
+  void motionStep(uint32_t nowMs);
+  void rampStep(uint32_t elapsed);
+  void finishMove(uint32_t elapsed);
+  uint16_t profileUs(uint32_t elapsed) const;
   void setState(BarrierState newState);
-  bool hasReachedTarget() const;
 
-  Servo servo_;
+  BarrierDrive drive_;
   uint8_t pin_{255};
-  
-  // Configuración de ángulos
-  uint8_t openAngle_{Cfg::kServoOpenDeg};
-  uint8_t closedAngle_{Cfg::kServoClosedDeg};
-  
+  const ProximitySensor* safe_{nullptr};
+  Scheduler::TaskId motionTask_{Scheduler::kInvalidTask};
+  Scheduler::TaskId consumer_{Scheduler::kInvalidTask};
+
+  // Configuración de posiciones (µs)
+  uint16_t openUs_{degToUs(Cfg::kServoOpenDeg)};
+  uint16_t closedUs_{degToUs(Cfg::kServoClosedDeg)};
+
   // Estado actual
   BarrierState state_{BarrierState::CLOSED};
-  uint8_t currentAngle_{Cfg::kServoClosedDeg};
-  uint8_t targetAngle_{Cfg::kServoClosedDeg};
-  
-  // Control de movimiento suave
-  uint32_t lastStepMs_{0};
+  uint16_t currentUs_{degToUs(Cfg::kServoClosedDeg)};
+
+  // Movimiento en curso: de fromUs_ a toUs_ en moveDurationMs_
+  uint16_t fromUs_{0};
+  uint16_t toUs_{0};
+  uint32_t moveDurationMs_{0};
+  uint8_t segment_{0};   // LEDC_FADE: tramos ya programados
   uint32_t commandStartMs_{0};
-  
-  // Timeouts
+  uint32_t commandStartUs_{0};
+  uint32_t lastOpenMs_{0};
+  uint32_t lastCloseMs_{0};
+
+  // Tiempos
   const uint32_t stepIntervalMs_ = Cfg::kBarrierStepMs;
-  const uint32_t openTimeoutMs_ = Cfg::kOpenTimeout;
-  const uint32_t closeTimeoutMs_ = Cfg::kCloseTimeout;
-  
-  // Para debugging/logging
-  BarrierState lastLoggedState_{BarrierState::CLOSED};
-};
\ No newline at end of file
+  uint32_t moveMs_ = Cfg::kBarrierMoveMs;
+  uint32_t openTimeoutMs_ = Cfg::kOpenTimeout;
+  uint32_t closeTimeoutMs_ = Cfg::kCloseTimeout;
+};
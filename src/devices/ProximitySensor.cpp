@@ -1,4 +1,5 @@
 #include "ProximitySensor.hpp"
+#include "core/InputSampler.hpp"
 #include "core/Logger.hpp"
 
 void ProximitySensor::begin(uint8_t pin, bool pullup, bool normallyHigh) {
@@ -8,57 +9,23 @@ void ProximitySensor::begin(uint8_t pin, bool pullup, bool normallyHigh) {
   
   pinMode(pin_, pullup_ ? INPUT_PULLUP : INPUT);
   
-  // Leer estado inicial
-  lastRaw_ = digitalRead(pin_) == HIGH;
-  stable_ = lastRaw_;
-  lastStable_ = stable_;
-  lastChange_ = millis();
+  // Registrar en el muestreo por lotes (toma el estado inicial).
+  // PNP (normallyHigh=true): HIGH cuando detecta
+  // NPN (normallyHigh=false): LOW cuando detecta
+  InputSampler::watch(pin_, !normallyHigh_);
   
   LOG_INFO("ProximitySensor initialized on pin %d (pullup: %d, normallyHigh: %d)", 
            pin_, pullup_, normallyHigh_);
 }
 
-bool ProximitySensor::isDetected(uint32_t nowMs) {
-  // Leer estado raw
-  bool raw = digitalRead(pin_) == HIGH;
-  
-  // Detectar cambios
-  if (raw != lastRaw_) {
-    lastChange_ = nowMs;
-    lastRaw_ = raw;
-  }
-  
-  // Aplicar debounce
-  if ((nowMs - lastChange_) > debounceMs_) {
-    stable_ = raw;
-  }
-  
-  // Interpretar según tipo de sensor:
-  // PNP (normallyHigh=true): HIGH cuando detecta
-  // NPN (normallyHigh=false): LOW cuando detecta
-  bool detected = normallyHigh_ ? stable_ : !stable_;
-  
-  return detected;
+bool ProximitySensor::isDetected() const {
+  return InputSampler::isActive(pin_);
 }
 
 bool ProximitySensor::wasActivated() {
-  bool currentDetected = normallyHigh_ ? stable_ : !stable_;
-  bool lastDetected = normallyHigh_ ? lastStable_ : !lastStable_;
-  
-  // Detectar flanco de activación
-  bool edge = currentDetected && !lastDetected;
-  lastStable_ = stable_;
-  
-  return edge;
+  return InputSampler::takeActivated(pin_);
 }
 
 bool ProximitySensor::wasDeactivated() {
-  bool currentDetected = normallyHigh_ ? stable_ : !stable_;
-  bool lastDetected = normallyHigh_ ? lastStable_ : !lastStable_;
-  
-  // Detectar flanco de desactivación
-  bool edge = !currentDetected && lastDetected;
-  lastStable_ = stable_;
-  
-  return edge;
-}
\ No newline at end of file
+  return InputSampler::takeDeactivated(pin_);
+}
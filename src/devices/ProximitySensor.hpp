@@ -2,10 +2,12 @@
 #include <Arduino.h>
 #include "core/Config.hpp"
 
+// Sensor sobre InputSampler: el debounce y los flancos se resuelven ahí
+// para todas las entradas a la vez, el objeto sólo guarda pin y polaridad.
 class ProximitySensor {
 public:
   void begin(uint8_t pin, bool pullup = true, bool normallyHigh = true);
-  bool isDetected(uint32_t nowMs);
+  bool isDetected() const;
   bool wasActivated(); // Edge detection - true cuando detecta presencia
   bool wasDeactivated(); // Edge detection - true cuando deja de detectar
   
@@ -13,9 +15,4 @@ private:
   uint8_t pin_{255};
   bool pullup_{true};
   bool normallyHigh_{true}; // true para sensores PNP, false para NPN
-  bool lastRaw_{false};
-  bool stable_{false};
-  bool lastStable_{false};
-  uint32_t lastChange_{0};
-  uint16_t debounceMs_{Cfg::kSensDebounceMs};
-};
\ No newline at end of file
+};
@@ -0,0 +1,90 @@
+#include "ServoDrive.hpp"
+
+#if BARRIER_DRIVE == BARRIER_DRIVE_LEDC_FADE
+#include "core/Logger.hpp"
+
+#ifndef SEMAFARO_HOST
+#include <esp_idf_version.h>
+#if ESP_IDF_VERSION_MAJOR < 5
+#error "BARRIER_DRIVE_LEDC_FADE needs ESP-IDF 5 (ledc_fade_stop); use BARRIER_DRIVE_SOFTWARE"
+#endif
+#endif
+
+namespace {
+  constexpr ledc_mode_t kMode = LEDC_LOW_SPEED_MODE;   // El S3 sólo tiene low-speed
+  constexpr uint32_t kPeriodUs = 1000000 / Cfg::kServoPwmHz;
+}
+
+void LedcFadeDrive::attach(uint8_t pin, uint16_t minUs, uint16_t maxUs) {
+  minUs_ = minUs;
+  maxUs_ = maxUs;
+
+  ledc_timer_config_t timer = {};
+  timer.speed_mode = kMode;
+  timer.duty_resolution = static_cast<ledc_timer_bit_t>(Cfg::kBarrierLedcBits);
+  timer.timer_num = static_cast<ledc_timer_t>(Cfg::kBarrierLedcTimer);
+  timer.freq_hz = Cfg::kServoPwmHz;
+  timer.clk_cfg = LEDC_AUTO_CLK;
+  ledc_timer_config(&timer);
+
+  ledc_channel_config_t channel = {};
+  channel.gpio_num = pin;
+  channel.speed_mode = kMode;
+  channel.channel = channel_;
+  channel.intr_type = LEDC_INTR_DISABLE;   // El fade habilita su propia interrupción
+  channel.timer_sel = timer.timer_num;
+  channel.duty = 0;
+  channel.hpoint = 0;
+  ledc_channel_config(&channel);
+
+  // Servicio de fades + callback de fin (corre en la interrupción)
+  ledc_fade_func_install(0);
+  ledc_cbs_t callbacks = {};
+  callbacks.fade_cb = &LedcFadeDrive::onFadeEnd;
+  ledc_cb_register(kMode, channel_, &callbacks, this);
+
+  LOG_INFO("Barrier LEDC fade drive on pin %d (channel %d, %d-bit)",
+           pin, Cfg::kBarrierLedcChannel, Cfg::kBarrierLedcBits);
+}
+
+void LedcFadeDrive::write(uint16_t us) {
+  hold();
+  ledc_set_duty_and_update(kMode, channel_, usToDuty(clamp(us)), 0);
+}
+
+void LedcFadeDrive::rampTo(uint16_t us, uint32_t ms) {
+  hold();
+  fading_.store(true, std::memory_order_release);
+  ledc_set_fade_time_and_start(kMode, channel_, usToDuty(clamp(us)), ms, LEDC_FADE_NO_WAIT);
+}
+
+uint16_t LedcFadeDrive::read() const {
+  return dutyToUs(ledc_get_duty(kMode, channel_));
+}
+
+void LedcFadeDrive::hold() {
+  if (!fading_.exchange(false, std::memory_order_acq_rel)) return;
+  ledc_fade_stop(kMode, channel_);   // El duty queda donde iba
+}
+
+bool IRAM_ATTR LedcFadeDrive::onFadeEnd(const ledc_cb_param_t* param, void* arg) {
+  auto* self = static_cast<LedcFadeDrive*>(arg);
+  if (param->event != LEDC_FADE_END_EVT) return false;
+  self->fading_.store(false, std::memory_order_release);
+  if (self->rampDoneTask_ != Scheduler::kInvalidTask) {
+    Scheduler::runSoonFromIsr(self->rampDoneTask_);
+  }
+  // runSoonFromIsr() ya pidió el cambio de contexto si hacía falta
+  return false;
+}
+
+uint32_t LedcFadeDrive::usToDuty(uint16_t us) {
+  return (static_cast<uint32_t>(us) << Cfg::kBarrierLedcBits) / kPeriodUs;
+}
+
+uint16_t LedcFadeDrive::dutyToUs(uint32_t duty) {
+  // Redondeo: ida y vuelta por usToDuty() conserva el valor
+  return static_cast<uint16_t>((static_cast<uint64_t>(duty) * kPeriodUs +
+                                (1u << (Cfg::kBarrierLedcBits - 1))) >> Cfg::kBarrierLedcBits);
+}
+#endif
@@ -0,0 +1,77 @@
+#pragma once
+#include <Arduino.h>
+#include <ESP32Servo.h>
+#include <type_traits>
+#include "core/Config.hpp"
+#include "core/Scheduler.hpp"
+
+#if BARRIER_DRIVE == BARRIER_DRIVE_LEDC_FADE
+#include <atomic>
+#include <driver/ledc.h>
+#endif
+
+// Salida PWM del servo de la barrera. Dos backends con la misma API,
+// elegidos en compilación con BARRIER_DRIVE (ver core/Config.hpp).
+// Posiciones en µs de pulso.
+
+// SOFTWARE: ESP32Servo; cada paso lo escribe la tarea de movimiento.
+// rampTo() salta al destino: la rampa la arma Barrier paso a paso.
+class SoftServoDrive {
+public:
+  static constexpr bool kHardwareRamp = false;
+
+  void attach(uint8_t pin, uint16_t minUs, uint16_t maxUs) { servo_.attach(pin, minUs, maxUs); }
+  void setRampDoneTask(Scheduler::TaskId) {}
+
+  void write(uint16_t us) {
+    servo_.writeMicroseconds(us);
+    us_ = us;
+  }
+  void rampTo(uint16_t us, uint32_t) { write(us); }
+  bool rampDone() const { return true; }
+  uint16_t read() const { return us_; }
+  void hold() {}
+
+private:
+  Servo servo_;
+  uint16_t us_{0};
+};
+
+#if BARRIER_DRIVE == BARRIER_DRIVE_LEDC_FADE
+// LEDC_FADE: rampTo() programa un fade lineal en el hardware LEDC y
+// vuelve; la interrupción de fin de fade arma la tarea indicada con
+// setRampDoneTask(). read() lee el registro de duty, así que a mitad de
+// un fade devuelve la posición real (Barrier::stop() la usa).
+class LedcFadeDrive {
+public:
+  static constexpr bool kHardwareRamp = true;
+
+  void attach(uint8_t pin, uint16_t minUs, uint16_t maxUs);
+  void setRampDoneTask(Scheduler::TaskId id) { rampDoneTask_ = id; }
+
+  void write(uint16_t us);
+  void rampTo(uint16_t us, uint32_t ms);
+  bool rampDone() const { return !fading_.load(std::memory_order_acquire); }
+  uint16_t read() const;
+  void hold();   // Cortar el fade en curso donde esté
+
+private:
+  static bool IRAM_ATTR onFadeEnd(const ledc_cb_param_t* param, void* arg);
+
+  uint16_t clamp(uint16_t us) const { return min(max(us, minUs_), maxUs_); }
+  static uint32_t usToDuty(uint16_t us);
+  static uint16_t dutyToUs(uint32_t duty);
+
+  ledc_channel_t channel_{static_cast<ledc_channel_t>(Cfg::kBarrierLedcChannel)};
+  uint16_t minUs_{Cfg::kServoMinUs};
+  uint16_t maxUs_{Cfg::kServoMaxUs};
+  std::atomic<bool> fading_{false};
+  Scheduler::TaskId rampDoneTask_{Scheduler::kInvalidTask};
+};
+#endif
+
+#if BARRIER_DRIVE == BARRIER_DRIVE_LEDC_FADE
+using BarrierDrive = LedcFadeDrive;
+#else
+using BarrierDrive = SoftServoDrive;
+#endif
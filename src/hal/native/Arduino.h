@@ -0,0 +1,84 @@
+#pragma once
+// Sustituto mínimo de <Arduino.h> para el build nativo (x86 Linux).
+// Sólo cubre la API que usa el firmware; el estado de pines y el reloj
+// virtual viven en HostHal.
+#include <stdint.h>
+#include <stddef.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <algorithm>
+
+#define SEMAFARO_HOST_HAL 1
+
+#define LOW  0x0
+#define HIGH 0x1
+
+#define INPUT        0x01
+#define OUTPUT       0x03
+#define INPUT_PULLUP 0x05
+
+using std::min;
+using std::max;
+
+// GPIO
+void pinMode(uint8_t pin, uint8_t mode);
+void digitalWrite(uint8_t pin, uint8_t val);
+int digitalRead(uint8_t pin);
+
+// Interrupciones GPIO: HostHal::setInput() dispara el ISR del pin
+#define IRAM_ATTR
+#define RISING  0x01
+#define FALLING 0x02
+#define CHANGE  0x03
+#define digitalPinToInterrupt(p) (p)
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode);
+void detachInterrupt(uint8_t pin);
+
+// Subconjunto de FreeRTOS: notificaciones de tarea sobre el reloj virtual.
+// Un tick = 1 ms (configTICK_RATE_HZ = 1000 como en el ESP32).
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef void* TaskHandle_t;
+#define pdFALSE 0
+#define pdTRUE  1
+#define portMAX_DELAY 0xFFFFFFFFu
+#define pdMS_TO_TICKS(ms) (static_cast<TickType_t>(ms))
+#define portYIELD_FROM_ISR(x) ((void)(x))
+TaskHandle_t xTaskGetCurrentTaskHandle();
+// Avanza el reloj virtual hasta una notificación (p.ej. desde un ISR
+// disparado por una entrada programada) o hasta agotar 'ticks'
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks);
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityWoken);
+
+// Tiempo (reloj virtual, avanza sólo con delay() o HostHal::advance*)
+uint32_t millis();     // 32 bits como en el ESP32 (incluye el desborde)
+uint32_t micros();
+void delay(uint32_t ms);
+void delayMicroseconds(uint32_t us);
+void yield();
+
+// Serial: escribe en stdout si el eco está habilitado
+class HostSerial {
+public:
+  void begin(unsigned long baud);
+  size_t printf(const char* fmt, ...);
+  size_t print(const char* s);
+  size_t println(const char* s = "");
+  size_t write(const uint8_t* data, size_t len);
+  size_t write(uint8_t b) { return write(&b, 1); }
+  int availableForWrite();
+  int available();
+  int read();
+  void flush();
+  explicit operator bool() const { return true; }
+};
+extern HostSerial Serial;
+
+// Subconjunto de la clase ESP
+class HostEsp {
+public:
+  uint32_t getFreeHeap();
+  uint32_t getCycleCount();
+  uint32_t getCpuFreqMHz() { return 240; }
+};
+extern HostEsp ESP;
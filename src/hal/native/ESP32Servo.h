@@ -0,0 +1,30 @@
+#pragma once
+// Sustituto de <ESP32Servo.h> para el build nativo.
+// El servo sólo guarda el último ancho de pulso; HostHal lo expone por pin.
+#include <Arduino.h>
+
+class ESP32PWM {
+public:
+  static void allocateTimer(int timerNumber) { (void)timerNumber; }
+};
+
+class Servo {
+public:
+  static constexpr int kDefaultMinUs = 544;
+  static constexpr int kDefaultMaxUs = 2400;
+
+  int attach(int pin, int minUs = kDefaultMinUs, int maxUs = kDefaultMaxUs);
+  void detach();
+  bool attached() const { return pin_ >= 0; }
+
+  void write(int value);               // Ángulo en grados (0-180)
+  void writeMicroseconds(int us);
+  int read() const;                    // Ángulo en grados
+  int readMicroseconds() const { return us_; }
+
+private:
+  int pin_{-1};
+  int minUs_{kDefaultMinUs};
+  int maxUs_{kDefaultMaxUs};
+  int us_{0};
+};
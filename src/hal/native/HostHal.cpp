@@ -0,0 +1,414 @@
+#include "HostHal.hpp"
+#include <ESP32Servo.h>
+#include <soc/gpio_struct.h>
+#include <driver/ledc.h>
+#include "core/Config.hpp"
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+
+HostSerial Serial;
+HostEsp ESP;
+
+namespace {
+  struct PinState {
+    uint8_t mode{INPUT};
+    bool input{false};
+    bool driven{false};   // El host fijó el nivel: el pullup no lo pisa
+    bool output{false};
+    int servoUs{0};
+    uint64_t servoChangedUs{0};
+    void (*isr)(void*){nullptr};
+    void* isrArg{nullptr};
+    int isrMode{0};
+  };
+
+  // Evento del reloj virtual: cambio de entrada, fin de un fade LEDC o
+  // despertar pedido por el programa host
+  struct ScheduledInput {
+    enum Kind : uint8_t { INPUT_CHANGE, FADE_END, WAKE } kind;
+    uint8_t pin;       // INPUT_CHANGE: pin; FADE_END: canal
+    bool high;
+  };
+
+  // Canal LEDC: duty fijo o fade lineal entre fromDuty y toDuty
+  struct LedcChannel {
+    int gpio{-1};
+    ledc_timer_t timer{LEDC_TIMER_0};
+    uint32_t duty{0};
+    bool fading{false};
+    uint32_t fromDuty{0};
+    uint64_t startUs{0};
+    uint64_t endUs{0};
+    ledc_cb_t cb{nullptr};
+    void* cbArg{nullptr};
+  };
+
+  struct LedcTimer {
+    uint32_t freqHz{50};
+    uint8_t bits{14};
+  };
+
+  // Un "chip" por hilo con SEMAFARO_TLS (barrido paralelo)
+  SEMAFARO_TLS PinState pins_[HostHal::kMaxPins];
+  SEMAFARO_TLS LedcChannel ledc_[LEDC_CHANNEL_MAX];
+  SEMAFARO_TLS LedcTimer ledcTimers_[LEDC_TIMER_MAX];
+  SEMAFARO_TLS std::multimap<uint64_t, ScheduledInput> scheduled_;
+  SEMAFARO_TLS uint64_t nowUs_{0};
+  SEMAFARO_TLS uint32_t notifications_{0};
+  SEMAFARO_TLS bool serialEcho_{true};
+
+  PinState* pinAt(uint8_t pin) {
+    return pin < HostHal::kMaxPins ? &pins_[pin] : nullptr;
+  }
+
+  LedcChannel* ledcAt(ledc_channel_t channel) {
+    return channel >= 0 && channel < LEDC_CHANNEL_MAX ? &ledc_[channel] : nullptr;
+  }
+
+  uint32_t ledcDutyNow(const LedcChannel& ch) {
+    if (!ch.fading || nowUs_ >= ch.endUs) return ch.duty;
+    // Avance lineal, como los pasos de duty del hardware
+    int64_t span = static_cast<int64_t>(ch.duty) - ch.fromDuty;
+    return static_cast<uint32_t>(ch.fromDuty + span * static_cast<int64_t>(nowUs_ - ch.startUs) /
+                                               static_cast<int64_t>(ch.endUs - ch.startUs));
+  }
+
+  void ledcFadeEnd(uint8_t channel, uint64_t atUs) {
+    LedcChannel& ch = ledc_[channel];
+    if (!ch.fading || ch.endUs != atUs) return;   // Detenido o reemplazado por otro fade
+    ch.fading = false;
+    if (ch.cb) {
+      ledc_cb_param_t param{LEDC_FADE_END_EVT, LEDC_LOW_SPEED_MODE, channel, ch.duty};
+      ch.cb(&param, ch.cbArg);   // Como la interrupción de fin de fade
+    }
+  }
+}
+
+// ---- HostHal ----
+
+uint64_t HostHal::nowUs() { return nowUs_; }
+void HostHal::setNowUs(uint64_t us) { nowUs_ = us; }
+namespace {
+  // Aplica las entradas programadas hasta 'targetUs' (inclusive) en orden.
+  // Con stopOnNotify, se detiene tras la primera que genere una notificación.
+  bool runUntil(uint64_t targetUs, bool stopOnNotify) {
+    while (!scheduled_.empty() && scheduled_.begin()->first <= targetUs) {
+      auto it = scheduled_.begin();
+      if (it->first > nowUs_) nowUs_ = it->first;
+      ScheduledInput in = it->second;
+      uint64_t atUs = it->first;
+      scheduled_.erase(it);
+      if (in.kind == ScheduledInput::FADE_END) {
+        ledcFadeEnd(in.pin, atUs);
+      } else if (in.kind == ScheduledInput::WAKE) {
+        notifications_++;
+      } else {
+        HostHal::setInput(in.pin, in.high);
+      }
+      if (stopOnNotify && notifications_ > 0) return true;
+    }
+    if (targetUs > nowUs_) nowUs_ = targetUs;
+    return false;
+  }
+}
+
+void HostHal::advanceUs(uint64_t us) { runUntil(nowUs_ + us, false); }
+
+void HostHal::setInput(uint8_t pin, bool high) {
+  auto* p = pinAt(pin);
+  if (!p) return;
+  bool changed = p->input != high;
+  p->input = high;
+  p->driven = true;
+
+  if (changed && p->isr && p->mode != OUTPUT) {
+    bool fire = p->isrMode == CHANGE || (p->isrMode == RISING && high) ||
+                (p->isrMode == FALLING && !high);
+    if (fire) p->isr(p->isrArg);
+  }
+}
+
+void HostHal::scheduleInput(uint64_t atUs, uint8_t pin, bool high) {
+  scheduled_.emplace(atUs, ScheduledInput{ScheduledInput::INPUT_CHANGE, pin, high});
+}
+
+void HostHal::scheduleWake(uint64_t atUs) {
+  scheduled_.emplace(atUs, ScheduledInput{ScheduledInput::WAKE, 0, false});
+}
+
+bool HostHal::getOutput(uint8_t pin) {
+  auto* p = pinAt(pin);
+  return p ? p->output : false;
+}
+
+uint8_t HostHal::getMode(uint8_t pin) {
+  auto* p = pinAt(pin);
+  return p ? p->mode : 0;
+}
+
+int HostHal::getServoUs(uint8_t pin) {
+  // Pin manejado por LEDC: ancho de pulso según el duty actual
+  for (const auto& ch : ledc_) {
+    if (ch.gpio == pin) {
+      const LedcTimer& t = ledcTimers_[ch.timer];
+      return static_cast<int>((static_cast<uint64_t>(ledcDutyNow(ch)) * 1000000 / t.freqHz) >> t.bits);
+    }
+  }
+  auto* p = pinAt(pin);
+  return p ? p->servoUs : 0;
+}
+
+uint64_t HostHal::getServoChangedUs(uint8_t pin) {
+  auto* p = pinAt(pin);
+  return p ? p->servoChangedUs : 0;
+}
+
+void HostHal::setServoUs(uint8_t pin, int us) {
+  auto* p = pinAt(pin);
+  if (!p || p->servoUs == us) return;
+  p->servoUs = us;
+  p->servoChangedUs = nowUs_;
+}
+
+void HostHal::setSerialEcho(bool enabled) { serialEcho_ = enabled; }
+
+void HostHal::reset() {
+  for (auto& p : pins_) p = PinState{};
+  for (auto& ch : ledc_) ch = LedcChannel{};
+  for (auto& t : ledcTimers_) t = LedcTimer{};
+  scheduled_.clear();
+  notifications_ = 0;
+  nowUs_ = 0;
+}
+
+// ---- API Arduino ----
+
+void pinMode(uint8_t pin, uint8_t mode) {
+  if (auto* p = pinAt(pin)) {
+    p->mode = mode;
+    // Con pullup y sin estímulo, la entrada queda en HIGH
+    if (mode == INPUT_PULLUP && !p->driven) p->input = true;
+  }
+}
+
+void digitalWrite(uint8_t pin, uint8_t val) {
+  if (auto* p = pinAt(pin)) p->output = val != LOW;
+}
+
+int digitalRead(uint8_t pin) {
+  auto* p = pinAt(pin);
+  if (!p) return LOW;
+  if (p->mode == OUTPUT) return p->output ? HIGH : LOW;
+  return p->input ? HIGH : LOW;
+}
+
+void attachInterruptArg(uint8_t pin, void (*isr)(void*), void* arg, int mode) {
+  if (auto* p = pinAt(pin)) {
+    p->isr = isr;
+    p->isrArg = arg;
+    p->isrMode = mode;
+  }
+}
+
+void detachInterrupt(uint8_t pin) {
+  if (auto* p = pinAt(pin)) p->isr = nullptr;
+}
+
+uint32_t millis() { return static_cast<uint32_t>(nowUs_ / 1000); }
+uint32_t micros() { return static_cast<uint32_t>(nowUs_); }
+void delay(uint32_t ms) { HostHal::advanceMs(ms); }
+void delayMicroseconds(uint32_t us) { HostHal::advanceUs(us); }
+void yield() {}
+
+// ---- FreeRTOS ----
+
+// Una sola tarea (la de loop()): el handle sólo tiene que ser no nulo
+TaskHandle_t xTaskGetCurrentTaskHandle() { return &notifications_; }
+
+uint32_t ulTaskNotifyTake(BaseType_t clearOnExit, TickType_t ticks) {
+  if (notifications_ == 0 && ticks > 0) {
+    // Sin nada programado una espera infinita no terminaría nunca
+    uint64_t targetUs = ticks == portMAX_DELAY
+        ? (scheduled_.empty() ? nowUs_ : scheduled_.rbegin()->first)
+        : nowUs_ + static_cast<uint64_t>(ticks) * 1000;
+    runUntil(targetUs, true);
+  }
+
+  uint32_t count = notifications_;
+  if (count > 0) notifications_ = clearOnExit ? 0 : count - 1;
+  return count;
+}
+
+void vTaskNotifyGiveFromISR(TaskHandle_t task, BaseType_t* higherPriorityWoken) {
+  (void)task;
+  notifications_++;
+  if (higherPriorityWoken) *higherPriorityWoken = pdTRUE;
+}
+
+// ---- LEDC ----
+
+esp_err_t ledc_timer_config(const ledc_timer_config_t* config) {
+  if (!config || config->timer_num >= LEDC_TIMER_MAX || config->freq_hz == 0) return ESP_ERR_INVALID_ARG;
+  ledcTimers_[config->timer_num] = LedcTimer{config->freq_hz, static_cast<uint8_t>(config->duty_resolution)};
+  return ESP_OK;
+}
+
+esp_err_t ledc_channel_config(const ledc_channel_config_t* config) {
+  if (!config) return ESP_ERR_INVALID_ARG;
+  auto* ch = ledcAt(config->channel);
+  if (!ch) return ESP_ERR_INVALID_ARG;
+  ch->gpio = config->gpio_num;
+  ch->timer = config->timer_sel;
+  ch->duty = config->duty;
+  ch->fading = false;
+  return ESP_OK;
+}
+
+esp_err_t ledc_fade_func_install(int intr_alloc_flags) {
+  (void)intr_alloc_flags;
+  return ESP_OK;
+}
+
+esp_err_t ledc_cb_register(ledc_mode_t mode, ledc_channel_t channel, ledc_cbs_t* cbs, void* user_arg) {
+  (void)mode;
+  auto* ch = ledcAt(channel);
+  if (!ch || !cbs) return ESP_ERR_INVALID_ARG;
+  ch->cb = cbs->fade_cb;
+  ch->cbArg = user_arg;
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_fade_time_and_start(ledc_mode_t mode, ledc_channel_t channel, uint32_t target_duty,
+                                       uint32_t max_fade_time_ms, ledc_fade_mode_t fade_mode) {
+  (void)mode;
+  (void)fade_mode;   // El firmware sólo usa NO_WAIT
+  auto* ch = ledcAt(channel);
+  if (!ch) return ESP_ERR_INVALID_ARG;
+  ch->fromDuty = ledcDutyNow(*ch);
+  ch->duty = target_duty;
+  ch->startUs = nowUs_;
+  ch->endUs = nowUs_ + static_cast<uint64_t>(max_fade_time_ms) * 1000;
+  ch->fading = true;
+  scheduled_.emplace(ch->endUs, ScheduledInput{ScheduledInput::FADE_END, static_cast<uint8_t>(channel), false});
+  if (ch->gpio >= 0 && ch->fromDuty != target_duty) {
+    if (auto* p = pinAt(static_cast<uint8_t>(ch->gpio))) p->servoChangedUs = nowUs_;
+  }
+  return ESP_OK;
+}
+
+esp_err_t ledc_set_duty_and_update(ledc_mode_t mode, ledc_channel_t channel, uint32_t duty, uint32_t hpoint) {
+  (void)mode;
+  (void)hpoint;
+  auto* ch = ledcAt(channel);
+  if (!ch) return ESP_ERR_INVALID_ARG;
+  if (ch->gpio >= 0 && ledcDutyNow(*ch) != duty) {
+    if (auto* p = pinAt(static_cast<uint8_t>(ch->gpio))) p->servoChangedUs = nowUs_;
+  }
+  ch->duty = duty;
+  ch->fading = false;
+  return ESP_OK;
+}
+
+esp_err_t ledc_fade_stop(ledc_mode_t mode, ledc_channel_t channel) {
+  (void)mode;
+  auto* ch = ledcAt(channel);
+  if (!ch) return ESP_ERR_INVALID_ARG;
+  // El duty queda donde iba el fade; sin callback (como en el IDF)
+  ch->duty = ledcDutyNow(*ch);
+  ch->fading = false;
+  return ESP_OK;
+}
+
+uint32_t ledc_get_duty(ledc_mode_t mode, ledc_channel_t channel) {
+  (void)mode;
+  auto* ch = ledcAt(channel);
+  return ch ? ledcDutyNow(*ch) : 0;
+}
+
+// ---- Registros GPIO ----
+
+HostGpioDev GPIO;
+
+HostGpioInReg::operator uint32_t() const {
+  uint32_t bits = 0;
+  for (uint8_t i = 0; i < 32 && firstPin + i < HostHal::kMaxPins; i++) {
+    if (digitalRead(firstPin + i) == HIGH) bits |= 1UL << i;
+  }
+  return bits;
+}
+
+// ---- Serial ----
+
+void HostSerial::begin(unsigned long baud) { (void)baud; }
+
+size_t HostSerial::printf(const char* fmt, ...) {
+  if (!serialEcho_) return 0;
+  va_list args;
+  va_start(args, fmt);
+  int n = vprintf(fmt, args);
+  va_end(args);
+  return n > 0 ? static_cast<size_t>(n) : 0;
+}
+
+size_t HostSerial::print(const char* s) {
+  if (!serialEcho_) return 0;
+  return static_cast<size_t>(fputs(s, stdout) >= 0 ? strlen(s) : 0);
+}
+
+size_t HostSerial::println(const char* s) {
+  size_t n = print(s);
+  return n + print("\n");
+}
+
+size_t HostSerial::write(const uint8_t* data, size_t len) {
+  if (!serialEcho_) return len;
+  return fwrite(data, 1, len, stdout);
+}
+
+int HostSerial::availableForWrite() { return 4096; }
+int HostSerial::available() { return 0; }
+int HostSerial::read() { return -1; }
+void HostSerial::flush() { fflush(stdout); }
+
+// ---- ESP ----
+
+uint32_t HostEsp::getFreeHeap() { return 0; }
+
+uint32_t HostEsp::getCycleCount() {
+  // Ciclos "equivalentes" a 240 MHz sobre el reloj monotónico del host
+  auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now().time_since_epoch()).count();
+  return static_cast<uint32_t>(static_cast<uint64_t>(ns) * 240 / 1000);
+}
+
+// ---- Servo ----
+
+int Servo::attach(int pin, int minUs, int maxUs) {
+  pin_ = pin;
+  minUs_ = minUs;
+  maxUs_ = maxUs;
+  return pin_;
+}
+
+void Servo::detach() { pin_ = -1; }
+
+void Servo::write(int value) {
+  // Igual que ESP32Servo: valores < minUs se interpretan como grados
+  if (value < minUs_) {
+    value = max(0, min(180, value));
+    value = minUs_ + (maxUs_ - minUs_) * value / 180;
+  }
+  writeMicroseconds(value);
+}
+
+void Servo::writeMicroseconds(int us) {
+  us_ = max(minUs_, min(maxUs_, us));
+  if (pin_ >= 0) HostHal::setServoUs(static_cast<uint8_t>(pin_), us_);
+}
+
+int Servo::read() const {
+  if (maxUs_ == minUs_) return 0;
+  return ((us_ - minUs_) * 180 + (maxUs_ - minUs_) / 2) / (maxUs_ - minUs_);
+}
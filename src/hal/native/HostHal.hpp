@@ -0,0 +1,38 @@
+#pragma once
+#include <Arduino.h>
+
+// Control del HAL nativo desde programas host (benchmarks, simulaciones).
+// El firmware nunca incluye este header: sólo ve la API Arduino.
+namespace HostHal {
+  constexpr uint8_t kMaxPins = 64;
+
+  // Reloj virtual
+  uint64_t nowUs();
+  void setNowUs(uint64_t us);
+  void advanceUs(uint64_t us);
+  inline void advanceMs(uint32_t ms) { advanceUs(static_cast<uint64_t>(ms) * 1000); }
+
+  // Entradas: nivel eléctrico visto por digitalRead(). Si el nivel cambia
+  // y el pin tiene ISR, se ejecuta en el acto (como una interrupción)
+  void setInput(uint8_t pin, bool high);
+  // Programar un cambio de entrada en el instante 'atUs' del reloj virtual;
+  // se aplica al avanzar el reloj (delay, ulTaskNotifyTake, advance*)
+  void scheduleInput(uint64_t atUs, uint8_t pin, bool high);
+  // Notificar a la tarea de loop() en 'atUs' sin tocar entradas: corta el
+  // sueño para que el programa host actúe en ese instante exacto
+  void scheduleWake(uint64_t atUs);
+  // Salidas: último nivel escrito con digitalWrite()
+  bool getOutput(uint8_t pin);
+  uint8_t getMode(uint8_t pin);
+
+  // Servo: último pulso (µs) escrito en el pin, 0 si nunca se escribió
+  int getServoUs(uint8_t pin);
+  uint64_t getServoChangedUs(uint8_t pin);  // Reloj virtual del último cambio de pulso
+  void setServoUs(uint8_t pin, int us); // Uso interno del stand-in de Servo
+
+  // Serial: eco a stdout (activo por defecto)
+  void setSerialEcho(bool enabled);
+
+  // Reinicia pines, ISRs, entradas programadas, servos y reloj
+  void reset();
+}
@@ -0,0 +1,17 @@
+#pragma once
+// Sustituto de soc/gpio_struct.h (ESP32-S3) para el build nativo.
+// Sólo expone los registros de entrada: GPIO.in (GPIO0-31) y
+// GPIO.in1.val (GPIO32-53). Cada lectura arma el valor desde el
+// estado de pines de HostHal, como si se leyera el registro.
+#include <stdint.h>
+
+struct HostGpioInReg {
+  uint8_t firstPin;
+  operator uint32_t() const;
+};
+
+struct HostGpioDev {
+  HostGpioInReg in{0};
+  struct { HostGpioInReg val{32}; } in1;
+};
+extern HostGpioDev GPIO;
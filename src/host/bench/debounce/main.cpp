@@ -0,0 +1,138 @@
+// Benchmark host: debounce por objeto (lastRaw_/stable_/lastChange_ como el
+// Button/ProximitySensor anterior) contra VerticalDebouncer, con 6, 64 y
+// 1024 entradas que rebotan al azar.
+//
+//   pio run -e bench_debounce && .pio/build/bench_debounce/program [ticks]
+//
+// Ambos caminos procesan la misma secuencia de muestras y deben contar los
+// mismos flancos; el programa falla si no coinciden.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "core/Config.hpp"
+#include "core/VerticalDebouncer.hpp"
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  using Debouncer = VerticalDebouncer<uint64_t, Cfg::kDebounceBits>;
+
+  // El camino anterior acepta cuando (ahora - último cambio) > debounce:
+  // con este valor cubre la misma ventana que el contador vertical
+  // ((2^bits - 1) periodos), así ambos deben contar los mismos flancos
+  constexpr uint16_t kLegacyDebounceMs =
+      (Debouncer::kSamplesToAccept - 1) * Cfg::kMainUpdateMs - 1;
+
+  // Camino anterior: debounce por timestamp, un objeto por entrada
+  struct LegacyInput {
+    bool lastRaw{false};
+    bool stable{false};
+    bool lastStable{false};
+    uint32_t lastChange{0};
+
+    void update(bool raw, uint32_t nowMs, uint16_t debounceMs, uint32_t& rising, uint32_t& falling) {
+      if (raw != lastRaw) {
+        lastChange = nowMs;
+        lastRaw = raw;
+      }
+      if ((nowMs - lastChange) > debounceMs) stable = raw;
+      if (stable != lastStable) {
+        (stable ? rising : falling)++;
+        lastStable = stable;
+      }
+    }
+  };
+
+  // Secuencia de muestras: cada entrada alterna periodos estables y ráfagas de rebote
+  std::vector<uint64_t> makeSamples(size_t inputs, size_t ticks, uint32_t seed) {
+    size_t words = (inputs + 63) / 64;
+    std::vector<uint64_t> samples(words * ticks, 0);
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> pct(0, 99);
+
+    for (size_t i = 0; i < inputs; i++) {
+      bool level = false;
+      int bounce = 0;
+      for (size_t t = 0; t < ticks; t++) {
+        if (bounce > 0) {
+          bounce--;
+          if (pct(rng) < 50) level = !level;
+        } else if (pct(rng) < 2) {
+          level = !level;
+          bounce = pct(rng) % 4;
+        }
+        if (level) samples[t * words + i / 64] |= uint64_t{1} << (i % 64);
+      }
+    }
+    return samples;
+  }
+
+  struct Result {
+    double nsPerTick;
+    uint32_t rising;
+    uint32_t falling;
+    size_t stateBytes;
+  };
+
+  Result runLegacy(const std::vector<uint64_t>& samples, size_t inputs, size_t ticks) {
+    size_t words = (inputs + 63) / 64;
+    std::vector<LegacyInput> objs(inputs);
+    uint32_t rising = 0, falling = 0;
+
+    auto t0 = Clock::now();
+    for (size_t t = 0; t < ticks; t++) {
+      uint32_t nowMs = static_cast<uint32_t>(t * Cfg::kMainUpdateMs);
+      const uint64_t* row = &samples[t * words];
+      for (size_t i = 0; i < inputs; i++) {
+        bool raw = (row[i / 64] >> (i % 64)) & 1;
+        objs[i].update(raw, nowMs, kLegacyDebounceMs, rising, falling);
+      }
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    return {static_cast<double>(ns) / ticks, rising, falling, inputs * sizeof(LegacyInput)};
+  }
+
+  Result runVertical(const std::vector<uint64_t>& samples, size_t inputs, size_t ticks) {
+    size_t words = (inputs + 63) / 64;
+    std::vector<Debouncer> banks(words);
+    uint32_t rising = 0, falling = 0;
+
+    auto t0 = Clock::now();
+    for (size_t t = 0; t < ticks; t++) {
+      const uint64_t* row = &samples[t * words];
+      for (size_t w = 0; w < words; w++) {
+        banks[w].update(row[w]);
+        rising += __builtin_popcountll(banks[w].takeRising(~uint64_t{0}));
+        falling += __builtin_popcountll(banks[w].takeFalling(~uint64_t{0}));
+      }
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    return {static_cast<double>(ns) / ticks, rising, falling, words * sizeof(Debouncer)};
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t ticks = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 200000;
+  bool ok = true;
+
+  printf("Debounce: %zu ticks a %lu ms, %lu muestras para aceptar un cambio\n",
+         ticks, (unsigned long)Cfg::kMainUpdateMs, (unsigned long)Debouncer::kSamplesToAccept);
+  printf("%8s | %14s %10s | %14s %10s | %7s | %s\n",
+         "inputs", "legacy ns/tick", "state B", "vertical ns/tick", "state B", "speedup", "edges");
+
+  for (size_t inputs : {6, 64, 1024}) {
+    auto samples = makeSamples(inputs, ticks, static_cast<uint32_t>(inputs));
+    Result legacy = runLegacy(samples, inputs, ticks);
+    Result vertical = runVertical(samples, inputs, ticks);
+
+    bool match = legacy.rising == vertical.rising && legacy.falling == vertical.falling;
+    ok = ok && match;
+    printf("%8zu | %14.1f %10zu | %16.1f %10zu | %6.1fx | %u/%u %s\n",
+           inputs, legacy.nsPerTick, legacy.stateBytes, vertical.nsPerTick, vertical.stateBytes,
+           legacy.nsPerTick / vertical.nsPerTick, vertical.rising, vertical.falling,
+           match ? "ok" : "MISMATCH");
+  }
+  return ok ? 0 : 1;
+}
@@ -0,0 +1,255 @@
+// Benchmark host: políticas de asignación de slots (app/SlotPolicy.hpp)
+// sobre un sitio de 3 niveles x 100 slots (10 VIP, 20 CARGA, 70 REGULAR por
+// nivel, tipos intercalados, numeración que salta de nivel en nivel y
+// distancias a la barrera desordenadas).
+//
+//   pio run -e bench_policy && .pio/build/bench_policy/program [horas]
+//
+// Por política:
+//  - ns/op: pares asignar/liberar con el estacionamiento ~90% lleno,
+//    contra el recorrido lineal original (lineal == FIRST_FREE + VIP_ONLY)
+//  - utilización bajo la misma traza de llegadas (Poisson con hora pico,
+//    estadías exponenciales): atendidos, rechazados, fallbacks, distancia
+//    media a la barrera, dispersión del uso por slot y niveles en uso.
+// El recorrido lineal y FIRST_FREE deben asignar los mismos slots; el
+// programa falla si no coinciden.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <array>
+#include <chrono>
+#include <queue>
+#include <random>
+#include <vector>
+#include "app/SlotLayout.hpp"
+#include "app/SlotPolicy.hpp"
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+  volatile uint64_t gSink;
+
+  constexpr size_t kLevels = 3;
+  constexpr size_t kPerLevel = 100;
+  constexpr size_t kSiteSlots = kLevels * kPerLevel;
+
+  // Numeración por columnas (índice i en el nivel i % 3). Por nivel, cada 10
+  // slots: 1 VIP, 2 CARGA y 7 REGULAR intercalados; distancia = rampa del
+  // nivel + posición en un recorrido que no sigue el índice
+  constexpr std::array<SlotSpec, kSiteSlots> makeSite() {
+    std::array<SlotSpec, kSiteSlots> t{};
+    for (size_t i = 0; i < kSiteSlots; i++) {
+      size_t level = i % kLevels;
+      size_t pos = i / kLevels;
+      size_t k = pos % 10;
+      SlotType type = k == 0 ? SlotType::VIP : k <= 2 ? SlotType::CARGA : SlotType::REGULAR;
+      uint16_t dist = static_cast<uint16_t>(level * 80 + (pos * 37) % kPerLevel);
+      t[i] = {static_cast<uint16_t>(i), type, static_cast<uint8_t>(level), dist, 0, {0, 0}, "S"};
+    }
+    return t;
+  }
+
+  struct Site {
+    static constexpr std::array<SlotSpec, kSiteSlots> kSlots = makeSite();
+  };
+  using Mask = Bitmap<kSiteSlots>;
+
+  // Núcleo de SlotManager::allocate()/setSlotState() sin hardware
+  template <template <typename> class Pick, typename Fallback>
+  struct Allocator {
+    std::array<Mask, 3> typeMask{};
+    Mask freeMask;
+    Pick<Site> pick;
+    uint32_t fallbacks{0};
+
+    Allocator() {
+      for (size_t i = 0; i < kSiteSlots; i++) {
+        typeMask[static_cast<size_t>(Site::kSlots[i].type)].set(i);
+      }
+      freeMask.setAll();
+      pick.reset();
+    }
+    int allocate(VehicleClass vc) {
+      const FallbackGraph& graph = Fallback::kGraph;
+      size_t row = static_cast<size_t>(vc);
+      for (uint8_t k = 0; k < graph.count[row]; k++) {
+        size_t t = static_cast<size_t>(graph.order[row][k]);
+        int slot = pick.pick(graph.order[row][k], typeMask[t], freeMask);
+        if (slot < 0) continue;
+        freeMask.clear(slot);
+        pick.onTaken(slot);
+        if (k > 0) fallbacks++;
+        return slot;
+      }
+      return -1;
+    }
+    void release(int slot) {
+      freeMask.set(slot);
+      pick.onFree(slot);
+    }
+  };
+
+  // Camino original: recorrido por índice con el fallback VIP de Cfg
+  struct LinearAllocator {
+    std::array<bool, kSiteSlots> free;
+    uint32_t fallbacks{0};
+
+    LinearAllocator() { free.fill(true); }
+    int find(SlotType t) const {
+      for (size_t i = 0; i < kSiteSlots; i++) {
+        if (Site::kSlots[i].type == t && free[i]) return static_cast<int>(i);
+      }
+      return -1;
+    }
+    int allocate(VehicleClass vc) {
+      int slot = find(static_cast<SlotType>(vc));
+      if (slot < 0 && vc == VehicleClass::VIP) {
+        slot = find(SlotPolicyDetail::kVipSecond);
+        if (slot < 0) slot = find(SlotPolicyDetail::kVipThird);
+        if (slot >= 0) fallbacks++;
+      }
+      if (slot >= 0) free[slot] = false;
+      return slot;
+    }
+    void release(int slot) { free[slot] = true; }
+  };
+
+  struct Arrival {
+    uint32_t atS;
+    uint32_t stayS;
+    VehicleClass vc;
+  };
+
+  // Llegadas Poisson: tasa base y pico de 8 a 10 h y de 17 a 19 h
+  std::vector<Arrival> makeTrace(uint32_t hours, uint32_t seed) {
+    std::vector<Arrival> out;
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    std::exponential_distribution<double> stay(1.0 / 7200.0);
+    for (uint32_t s = 0; s < hours * 3600; s++) {
+      uint32_t hour = (s / 3600) % 24;
+      bool peak = (hour >= 8 && hour < 10) || (hour >= 17 && hour < 19);
+      double perS = (peak ? 170.0 : 60.0) / 3600.0;
+      if (u(rng) >= perS) continue;
+      double c = u(rng);
+      VehicleClass vc = c < 0.12 ? VehicleClass::VIP : c < 0.30 ? VehicleClass::CARGA : VehicleClass::REGULAR;
+      out.push_back({s, 60 + static_cast<uint32_t>(stay(rng)), vc});
+    }
+    return out;
+  }
+
+  struct Usage {
+    uint32_t served{0};
+    uint32_t rejected{0};
+    uint32_t fallbacks{0};
+    double avgDist{0};
+    double useCv{0};          // Coef. de variación de usos por slot (menor = más parejo)
+    double avgLevels{0};      // Niveles con algún slot ocupado, promedio por minuto
+    uint64_t checksum{0};
+  };
+
+  template <typename Alloc>
+  Usage simulate(const std::vector<Arrival>& trace) {
+    Alloc alloc;
+    Usage u;
+    std::array<uint32_t, kSiteSlots> uses{};
+    std::array<uint32_t, kLevels> occupiedOnLevel{};
+    using Departure = std::pair<uint32_t, int>;
+    std::priority_queue<Departure, std::vector<Departure>, std::greater<Departure>> departures;
+    uint64_t distSum = 0, levelSamples = 0, levelSum = 0;
+    uint32_t nextSample = 0;
+
+    auto advance = [&](uint32_t now) {
+      while (!departures.empty() && departures.top().first <= now) {
+        int slot = departures.top().second;
+        departures.pop();
+        alloc.release(slot);
+        occupiedOnLevel[Site::kSlots[slot].level]--;
+      }
+      for (; nextSample <= now; nextSample += 60) {
+        for (uint32_t n : occupiedOnLevel) levelSum += n > 0;
+        levelSamples++;
+      }
+    };
+
+    for (const Arrival& a : trace) {
+      advance(a.atS);
+      int slot = alloc.allocate(a.vc);
+      u.checksum = u.checksum * 31 + static_cast<uint64_t>(slot + 1);
+      if (slot < 0) {
+        u.rejected++;
+        continue;
+      }
+      u.served++;
+      uses[slot]++;
+      distSum += Site::kSlots[slot].gateDist;
+      occupiedOnLevel[Site::kSlots[slot].level]++;
+      departures.push({a.atS + a.stayS, slot});
+    }
+
+    double mean = 0, var = 0;
+    for (uint32_t n : uses) mean += n;
+    mean /= kSiteSlots;
+    for (uint32_t n : uses) var += (n - mean) * (n - mean);
+    u.fallbacks = alloc.fallbacks;
+    u.avgDist = u.served ? static_cast<double>(distSum) / u.served : 0;
+    u.useCv = mean > 0 ? sqrt(var / kSiteSlots) / mean : 0;
+    u.avgLevels = levelSamples ? static_cast<double>(levelSum) / levelSamples : 0;
+    return u;
+  }
+
+  // Pares asignar/liberar sobre un estacionamiento ~90% lleno
+  template <typename Alloc>
+  double nsPerOp(size_t ops) {
+    Alloc alloc;
+    std::mt19937 rng(7);
+    std::uniform_int_distribution<int> cls(0, 2);
+    for (size_t i = 0; i < kSiteSlots * 9 / 10; i++) {
+      alloc.allocate(static_cast<VehicleClass>(i % 3));
+    }
+    std::vector<VehicleClass> classes(ops);
+    for (auto& c : classes) c = static_cast<VehicleClass>(cls(rng));
+
+    uint64_t sink = 0;
+    auto t0 = Clock::now();
+    for (size_t i = 0; i < ops; i++) {
+      int slot = alloc.allocate(classes[i]);
+      sink += static_cast<uint64_t>(slot + 1);
+      if (slot >= 0) alloc.release(slot);
+    }
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    gSink = sink;   // Que el lazo no se descarte
+    return static_cast<double>(ns) / ops;
+  }
+
+  template <typename Alloc>
+  Usage report(const char* name, const std::vector<Arrival>& trace, size_t ops) {
+    double ns = nsPerOp<Alloc>(ops);
+    Usage u = simulate<Alloc>(trace);
+    printf("%-24s | %7.1f | %6u %6u %5u | %7.1f m | %5.2f | %4.2f\n",
+           name, ns, u.served, u.rejected, u.fallbacks, u.avgDist, u.useCv, u.avgLevels);
+    return u;
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t hours = argc > 1 ? static_cast<uint32_t>(atol(argv[1])) : 24 * 7;
+  size_t ops = 1000000;
+  auto trace = makeTrace(hours, 2024);
+
+  printf("Sitio: %zu niveles x %zu slots; %u h, %zu llegadas\n", kLevels, kPerLevel, hours, trace.size());
+  printf("%-24s | %7s | %6s %6s %5s | %9s | %5s | %s\n",
+         "policy", "ns/op", "served", "reject", "fallb", "dist avg", "useCV", "levels");
+
+  Usage linear = report<LinearAllocator>("linear (original)", trace, ops);
+  Usage first = report<Allocator<FirstFreePick, VipOnlyFallback>>("FIRST_FREE", trace, ops);
+  report<Allocator<NearestGatePick, VipOnlyFallback>>("NEAREST_GATE", trace, ops);
+  report<Allocator<LeastRecentPick, VipOnlyFallback>>("LEAST_RECENT", trace, ops);
+  report<Allocator<LevelFillPick, VipOnlyFallback>>("LEVEL_FILL", trace, ops);
+  report<Allocator<FirstFreePick, RegularToCargaFallback>>("FIRST_FREE +REG->CARGA", trace, ops);
+  report<Allocator<NearestGatePick, RegularToCargaFallback>>("NEAREST_GATE +REG->CARGA", trace, ops);
+
+  bool match = linear.checksum == first.checksum;
+  printf("linear vs FIRST_FREE: %s\n", match ? "ok" : "MISMATCH");
+  return match ? 0 : 1;
+}
@@ -0,0 +1,175 @@
+// Benchmark host: búsqueda de slots por recorrido lineal (como el
+// SlotManager anterior) contra el índice de mapas de bits (core/Bitmap.hpp),
+// con 6, 256 y 4096 slots repartidos en tercios VIP/CARGA/REGULAR.
+//
+//   pio run -e bench_slots && .pio/build/bench_slots/program [ops]
+//
+// allocate: asignaciones (VIP con fallback CARGA -> REGULAR) intercaladas
+// con liberaciones al azar, con el estacionamiento ~90% lleno.
+// freeCount: conteo de libres por tipo, como printStatus()/allFull().
+// Ambos caminos procesan la misma secuencia y deben asignar los mismos
+// slots; el programa falla si no coinciden.
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <array>
+#include <chrono>
+#include <random>
+#include <vector>
+#include "core/Bitmap.hpp"
+#include "core/Types.hpp"
+
+namespace {
+  using Clock = std::chrono::steady_clock;
+
+  struct Op {
+    bool release;     // true: liberar 'arg' si está ocupado; false: asignar clase 'arg'
+    uint16_t arg;
+  };
+
+  SlotType typeOf(size_t i, size_t slots) {
+    return static_cast<SlotType>(i * 3 / slots);
+  }
+
+  // Camino anterior: recorrer los slots comparando tipo y estado
+  template <size_t N>
+  struct LinearIndex {
+    std::array<SlotType, N> type;
+    std::array<SlotState, N> state;
+
+    LinearIndex() {
+      for (size_t i = 0; i < N; i++) {
+        type[i] = typeOf(i, N);
+        state[i] = SlotState::FREE;
+      }
+    }
+    int findType(SlotType t) const {
+      for (size_t i = 0; i < N; i++) {
+        if (type[i] == t && state[i] == SlotState::FREE) return static_cast<int>(i);
+      }
+      return -1;
+    }
+    size_t freeCount(SlotType t) const {
+      size_t n = 0;
+      for (size_t i = 0; i < N; i++) {
+        if (type[i] == t && state[i] == SlotState::FREE) n++;
+      }
+      return n;
+    }
+    void setState(size_t i, SlotState s) { state[i] = s; }
+  };
+
+  // Camino nuevo: el índice del SlotManager
+  template <size_t N>
+  struct BitmapIndex {
+    std::array<Bitmap<N>, 3> typeMask;
+    Bitmap<N> freeMask;
+    std::array<SlotState, N> state;
+
+    BitmapIndex() {
+      for (size_t i = 0; i < N; i++) {
+        typeMask[static_cast<size_t>(typeOf(i, N))].set(i);
+        freeMask.set(i);
+        state[i] = SlotState::FREE;
+      }
+    }
+    int findType(SlotType t) const {
+      return Bitmap<N>::firstAnd(typeMask[static_cast<size_t>(t)], freeMask);
+    }
+    size_t freeCount(SlotType t) const {
+      return Bitmap<N>::countAnd(typeMask[static_cast<size_t>(t)], freeMask);
+    }
+    void setState(size_t i, SlotState s) {
+      state[i] = s;
+      freeMask.assign(i, s == SlotState::FREE);
+    }
+  };
+
+  template <typename Index>
+  int allocate(Index& index, VehicleClass vc) {
+    int slot = index.findType(static_cast<SlotType>(vc));
+    if (slot < 0 && vc == VehicleClass::VIP) {
+      slot = index.findType(SlotType::CARGA);
+      if (slot < 0) slot = index.findType(SlotType::REGULAR);
+    }
+    if (slot >= 0) index.setState(slot, SlotState::OCCUPIED);
+    return slot;
+  }
+
+  // Llenado inicial al 90% y luego pares asignar/liberar que lo mantienen
+  std::vector<Op> makeOps(size_t slots, size_t ops, uint32_t seed) {
+    std::vector<Op> out;
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> cls(0, 2);
+    std::uniform_int_distribution<size_t> idx(0, slots - 1);
+    for (size_t i = 0; i < slots * 9 / 10; i++) {
+      out.push_back({false, static_cast<uint16_t>(i * 3 / slots)});
+    }
+    for (size_t i = 0; i < ops; i++) {
+      out.push_back({true, static_cast<uint16_t>(idx(rng))});
+      out.push_back({false, static_cast<uint16_t>(cls(rng))});
+    }
+    return out;
+  }
+
+  struct Result {
+    double allocNs;      // ns por operación (asignar o liberar)
+    double countNs;      // ns por freeCount()
+    uint64_t checksum;   // Suma de slots asignados + conteos
+  };
+
+  template <typename Index>
+  Result run(const std::vector<Op>& ops, size_t countCalls) {
+    Index index;
+    uint64_t checksum = 0;
+
+    auto t0 = Clock::now();
+    for (const Op& op : ops) {
+      if (op.release) {
+        if (index.state[op.arg] != SlotState::FREE) index.setState(op.arg, SlotState::FREE);
+      } else {
+        checksum += static_cast<uint64_t>(allocate(index, static_cast<VehicleClass>(op.arg)) + 1);
+      }
+    }
+    auto t1 = Clock::now();
+    for (size_t i = 0; i < countCalls; i++) {
+      checksum += index.freeCount(static_cast<SlotType>(i % 3));
+    }
+    auto t2 = Clock::now();
+
+    auto ns = [](Clock::duration d) {
+      return static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(d).count());
+    };
+    return {ns(t1 - t0) / ops.size(), ns(t2 - t1) / countCalls, checksum};
+  }
+
+  template <size_t N>
+  bool compare(size_t ops) {
+    auto trace = makeOps(N, ops, static_cast<uint32_t>(N));
+    size_t countCalls = ops;
+    Result linear = run<LinearIndex<N>>(trace, countCalls);
+    Result bitmap = run<BitmapIndex<N>>(trace, countCalls);
+
+    bool match = linear.checksum == bitmap.checksum;
+    printf("%6zu | %12.1f %12.1f %7.1fx | %12.1f %12.1f %7.1fx | %s\n",
+           N, linear.allocNs, bitmap.allocNs, linear.allocNs / bitmap.allocNs,
+           linear.countNs, bitmap.countNs, linear.countNs / bitmap.countNs,
+           match ? "ok" : "MISMATCH");
+    return match;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t ops = argc > 1 ? static_cast<size_t>(atol(argv[1])) : 200000;
+  bool ok = true;
+
+  printf("Slots: %zu pares liberar/asignar con el 90%% ocupado, %zu freeCount()\n", ops, ops);
+  printf("%6s | %12s %12s %8s | %12s %12s %8s |\n",
+         "slots", "linear ns/op", "bitmap ns/op", "speedup",
+         "linear count", "bitmap count", "speedup");
+
+  ok = compare<6>(ops) && ok;
+  ok = compare<256>(ops) && ok;
+  ok = compare<4096>(ops) && ok;
+  return ok ? 0 : 1;
+}
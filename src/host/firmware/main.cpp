@@ -0,0 +1,246 @@
+// Ejecuta el firmware real (setup()/loop() de src/main.cpp) sobre el HAL
+// nativo con reloj virtual. Pensado para perf/valgrind:
+//
+//   pio run -e native && perf record .pio/build/native/program --seconds 3600 --quiet
+//
+// Un guion de estímulos simula un vehículo entrando y saliendo cada minuto.
+// Cada ciclo se corre unos ms para que las pulsaciones caigan en distintas
+// fases del tick de 50 ms. Al final reporta despertares de loop() por hora
+// y la latencia de reacción en tiempo virtual (pulsación -> comando de
+// apertura y pulsación -> primer movimiento del servo); comparar LOOP_MODE
+// con los entornos native/native_polling.
+//
+// --peak usa un guion de hora pico (ráfagas de entradas y salidas) para
+// medir la cola de pedidos: profundidad, espera y vehículos por hora.
+// --fixed-pass desactiva la detección de paso (siempre espera kPassTimeMs)
+// para comparar el tiempo de ciclo de la barrera.
+// --record <archivo> guarda la traza de entradas para host/replay.
+// --metrics vuelca al final el snapshot de core/Metrics (como el comando 'M').
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <deque>
+#include <vector>
+#include "hal/native/HostHal.hpp"
+#include "core/Pins.hpp"
+#include "core/Config.hpp"
+#include "core/Metrics.hpp"
+#include "app/AccessController.hpp"
+#include "devices/Barrier.hpp"
+#include "host/replay/TraceFile.hpp"
+
+void setup();
+void loop();
+extern SEMAFARO_TLS AccessController accessController;
+extern SEMAFARO_TLS Barrier barrier;
+
+namespace {
+  struct Stimulus {
+    uint32_t atMs;   // Offset dentro del ciclo de 60 s
+    uint8_t pin;
+    bool high;
+  };
+
+  // Botones activo-bajo, sensores PNP activo-alto
+  constexpr Stimulus kScript[] = {
+    {1000,  Pins::BTN_VIP_IN,      false},
+    {1200,  Pins::BTN_VIP_IN,      true},
+    {3000,  Pins::BARRIER_SAFE_IN, true},
+    {4000,  Pins::BARRIER_SAFE_IN, false},
+    {8000,  Pins::S_VIP1,          true},
+    {40000, Pins::S_VIP1,          false},
+    {42000, Pins::BTN_EXIT,        false},
+    {42200, Pins::BTN_EXIT,        true},
+    {44000, Pins::BARRIER_SAFE_IN, true},
+    {45000, Pins::BARRIER_SAFE_IN, false},
+  };
+
+  // Hora pico: tres entradas en ráfaga y, más tarde, dos salidas seguidas;
+  // cada vehículo cruza el sensor de seguridad ~1 s después del anterior.
+  // Sin sensores de slot: las reservas vencen solas (Cfg::kSlotReserveMs)
+  constexpr Stimulus kPeakScript[] = {
+    {1000,  Pins::BTN_VIP_IN,      false},
+    {1200,  Pins::BTN_VIP_IN,      true},
+    {1500,  Pins::BTN_REG_IN,      false},
+    {1700,  Pins::BTN_REG_IN,      true},
+    {2500,  Pins::BTN_CARGA_IN,    false},
+    {2700,  Pins::BTN_CARGA_IN,    true},
+    {3000,  Pins::BARRIER_SAFE_IN, true},
+    {4000,  Pins::BARRIER_SAFE_IN, false},
+    {5000,  Pins::BARRIER_SAFE_IN, true},
+    {6000,  Pins::BARRIER_SAFE_IN, false},
+    {7000,  Pins::BARRIER_SAFE_IN, true},
+    {8000,  Pins::BARRIER_SAFE_IN, false},
+    {30000, Pins::BTN_EXIT,        false},
+    {30200, Pins::BTN_EXIT,        true},
+    {32000, Pins::BARRIER_SAFE_IN, true},
+    {33000, Pins::BARRIER_SAFE_IN, false},
+    {32500, Pins::BTN_EXIT,        false},
+    {32700, Pins::BTN_EXIT,        true},
+    {34000, Pins::BARRIER_SAFE_IN, true},
+    {35000, Pins::BARRIER_SAFE_IN, false},
+  };
+  constexpr uint32_t kScriptPeriodMs = 60000;
+
+  // Latencias de reacción acumuladas (us de reloj virtual)
+  struct Latency {
+    uint64_t count{0};
+    uint64_t totalUs{0};
+    uint64_t maxUs{0};
+
+    void add(uint64_t us) {
+      count++;
+      totalUs += us;
+      if (us > maxUs) maxUs = us;
+    }
+    double avgMs() const { return count ? totalUs / 1000.0 / count : 0.0; }
+  };
+
+  bool isButton(uint8_t pin) {
+    return pin == Pins::BTN_VIP_IN || pin == Pins::BTN_CARGA_IN ||
+           pin == Pins::BTN_REG_IN || pin == Pins::BTN_EXIT;
+  }
+
+  // Programa el guion completo en el reloj virtual: cada cambio se aplica
+  // en su instante exacto (y dispara el ISR del pin si lo hay).
+  // Retorna los instantes de pulsación (flanco activo-bajo de un botón).
+  template <size_t N>
+  std::deque<uint64_t> scheduleScript(const Stimulus (&script)[N], uint64_t startUs, uint32_t seconds) {
+    std::deque<uint64_t> presses;
+    uint32_t cycle = 0;
+    for (uint32_t base = 0; base < seconds * 1000; base += kScriptPeriodMs, cycle++) {
+      uint64_t shiftUs = (cycle * 7919ULL) % (Cfg::kMainUpdateMs * 1000);
+      for (const auto& s : script) {
+        uint64_t atUs = startUs + (static_cast<uint64_t>(base) + s.atMs) * 1000 + shiftUs;
+        HostHal::scheduleInput(atUs, s.pin, s.high);
+        if (isButton(s.pin) && !s.high) presses.push_back(atUs);
+      }
+    }
+    return presses;
+  }
+}
+
+int main(int argc, char** argv) {
+  uint32_t seconds = 300;
+  bool peak = false;
+  bool fixedPass = false;
+  const char* recordPath = nullptr;
+  bool metrics = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--seconds") == 0 && i + 1 < argc) {
+      seconds = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--quiet") == 0) {
+      HostHal::setSerialEcho(false);
+    } else if (strcmp(argv[i], "--peak") == 0) {
+      peak = true;
+    } else if (strcmp(argv[i], "--fixed-pass") == 0) {
+      fixedPass = true;
+    } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      recordPath = argv[++i];
+    } else if (strcmp(argv[i], "--metrics") == 0) {
+      metrics = true;
+    }
+  }
+
+  // Estado eléctrico de reposo: botones sin pulsar, sensores sin detección
+  for (uint8_t pin : {Pins::BTN_VIP_IN, Pins::BTN_CARGA_IN, Pins::BTN_REG_IN, Pins::BTN_EXIT}) {
+    HostHal::setInput(pin, true);
+  }
+  for (uint8_t pin : {Pins::BARRIER_SAFE_IN, Pins::S_VIP1, Pins::S_VIP2, Pins::S_CARG1,
+                      Pins::S_CARG2, Pins::S_REG1, Pins::S_REG2}) {
+    HostHal::setInput(pin, false);
+  }
+
+  // Con --record, espacio de sobra para la traza (la RAM interna es chica)
+  std::vector<uint8_t> traceBuf(recordPath ? Cfg::kTracePsramBytes : 0);
+  if (recordPath) InputTrace::useBuffer(traceBuf.data(), traceBuf.size());
+
+  setup();
+  if (fixedPass) accessController.setPassDetection(false);
+  std::deque<uint64_t> presses = peak ? scheduleScript(kPeakScript, HostHal::nowUs(), seconds)
+                                      : scheduleScript(kScript, HostHal::nowUs(), seconds);
+
+  using Clock = std::chrono::steady_clock;
+  const uint32_t startMs = millis();
+  const uint32_t endMs = startMs + seconds * 1000;
+  uint64_t loops = 0;
+  uint64_t totalNs = 0;
+  uint64_t maxNs = 0;
+
+  // Latencia de reacción: de la pulsación al comando de apertura y al primer
+  // cambio del servo. La diferencia es el arranque suave del perfil: con la
+  // curva S los primeros pasos casi no cambian el pulso
+  BarrierState lastBarrier = barrier.getState();
+  int lastServoUs = HostHal::getServoUs(Pins::SERVO_PWM);
+  uint64_t pressUs = 0;
+  bool awaitingServo = false;
+  Latency toCommand;
+  Latency toServo;
+
+  while (millis() < endMs) {
+    auto t0 = Clock::now();
+    loop();
+    auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0).count();
+    totalNs += ns;
+    if (static_cast<uint64_t>(ns) > maxNs) maxNs = ns;
+    loops++;
+
+    BarrierState barrierState = barrier.getState();
+    // Con --peak las pulsaciones se encolan: la espera la reporta la cola
+    if (!peak && barrierState == BarrierState::OPENING && lastBarrier != BarrierState::OPENING &&
+        !presses.empty() && presses.front() <= HostHal::nowUs()) {
+      // loop() ya durmió hasta el próximo vencimiento: usar el instante del
+      // comando (micros() de 32 bits; la resta sobrevive a la vuelta)
+      pressUs = presses.front();
+      presses.pop_front();
+      toCommand.add(static_cast<uint32_t>(barrier.lastCommandUs() - static_cast<uint32_t>(pressUs)));
+      awaitingServo = true;
+    }
+    int servoUs = HostHal::getServoUs(Pins::SERVO_PWM);
+    if (awaitingServo && servoUs != lastServoUs) {
+      // Igual que el comando: el instante del cambio, no el del despertar
+      toServo.add(HostHal::getServoChangedUs(Pins::SERVO_PWM) - pressUs);
+      awaitingServo = false;
+    }
+    lastServoUs = servoUs;
+    lastBarrier = barrierState;
+  }
+
+  fprintf(stderr, "virtual: %u s, loop() calls: %llu, avg %.1f ns, max %.1f us\n",
+          seconds, static_cast<unsigned long long>(loops),
+          loops ? static_cast<double>(totalNs) / loops : 0.0, maxNs / 1000.0);
+  fprintf(stderr, "LOOP_MODE=%s: %.0f wakeups/h, reaction to open command avg %.3f ms, "
+          "max %.3f ms; to first servo change avg %.3f ms, max %.3f ms (%llu presses)\n",
+          LOOP_MODE == LOOP_MODE_EVENT ? "EVENT" : "POLLING",
+          seconds ? loops * 3600.0 / seconds : 0.0,
+          toCommand.avgMs(), toCommand.maxUs / 1000.0, toServo.avgMs(), toServo.maxUs / 1000.0,
+          static_cast<unsigned long long>(toCommand.count));
+
+  const auto& st = accessController.stats();
+  const auto& q = accessController.queue().stats();
+  fprintf(stderr, "requests: %u entries, %u exits, %u chained, %u denied, %u dropped, "
+          "%u arrived busy\n", st.entries, st.exits, st.chained, st.denied, q.dropped,
+          st.arrivedBusy);
+  fprintf(stderr, "queue: max depth %u, wait avg %u ms, max %u ms; %u vehicles/h\n",
+          q.maxDepth, accessController.queue().avgWaitMs(), q.maxWaitMs,
+          accessController.vehiclesPerHour(millis()));
+  fprintf(stderr, "gate cycle (%s): %u cycles, avg %.0f ms, max %u ms; %u passages, %u pass timeouts\n",
+          fixedPass ? "fixed pass time" : "pass detection", st.cycles,
+          st.cycles ? static_cast<double>(st.totalCycleMs) / st.cycles : 0.0, st.maxCycleMs,
+          st.passages, st.passTimeouts);
+  fprintf(stderr, "barrier motion: open %u ms, close %u ms (nominal %u ms at %u ms/step)\n",
+          barrier.lastOpenMs(), barrier.lastCloseMs(), barrier.nominalMoveMs(), Cfg::kBarrierStepMs);
+  if (metrics) {
+    HostHal::setSerialEcho(true);
+    Metrics::dump();
+  }
+  if (recordPath) {
+    if (!TraceFile::save(recordPath)) {
+      fprintf(stderr, "cannot write %s\n", recordPath);
+      return 1;
+    }
+    fprintf(stderr, "input trace: %u bytes -> %s\n", (unsigned)InputTrace::dumpBytes(), recordPath);
+  }
+  return 0;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "core/InputTrace.hpp"
+
+// Archivos de traza (core/InputTrace) para los programas host: binario tal
+// cual sale de InputTrace::copyTo(), o la captura de texto del volcado por
+// Serial (líneas "TRACE <hex>", el resto del log se ignora).
+namespace TraceFile {
+  // Guarda la traza del firmware que corre en este hilo
+  inline bool save(const char* path) {
+    std::vector<uint8_t> data(InputTrace::dumpBytes());
+    size_t n = InputTrace::copyTo(data.data(), data.size());
+    FILE* f = fopen(path, "wb");
+    if (!f) return false;
+    bool ok = fwrite(data.data(), 1, n, f) == n;
+    return fclose(f) == 0 && ok;
+  }
+
+  inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    return -1;
+  }
+
+  inline bool load(const char* path, std::vector<uint8_t>& out) {
+    FILE* f = fopen(path, "rb");
+    if (!f) return false;
+    std::vector<uint8_t> raw;
+    uint8_t chunk[4096];
+    size_t n;
+    while ((n = fread(chunk, 1, sizeof(chunk), f)) > 0) raw.insert(raw.end(), chunk, chunk + n);
+    fclose(f);
+
+    if (raw.size() >= 4 && memcmp(raw.data(), "STRC", 4) == 0) {
+      out.swap(raw);
+      return true;
+    }
+
+    // Captura de texto: juntar el hex de las líneas "TRACE " (no las "=== TRACE")
+    out.clear();
+    raw.push_back('\n');
+    const char* p = reinterpret_cast<const char*>(raw.data());
+    const char* end = p + raw.size();
+    while (p < end) {
+      const char* eol = static_cast<const char*>(memchr(p, '\n', end - p));
+      if (static_cast<size_t>(eol - p) > 6 && strncmp(p, "TRACE ", 6) == 0) {
+        for (const char* h = p + 6; h + 1 < eol; h += 2) {
+          int hi = hexValue(h[0]);
+          int lo = hexValue(h[1]);
+          if (hi < 0 || lo < 0) break;
+          out.push_back(static_cast<uint8_t>(hi << 4 | lo));
+        }
+      }
+      p = eol + 1;
+    }
+    return !out.empty();
+  }
+}
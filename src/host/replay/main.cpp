@@ -0,0 +1,242 @@
+// Reproduce una traza de entradas (core/InputTrace) sobre el firmware real
+// (setup() de src/main.cpp, AccessController, SlotManager, Barrier) con el
+// reloj virtual del HAL nativo, y compara las marcas de la FSM/barrera que
+// produce este build con las grabadas.
+//
+//   pio run -e replay && .pio/build/replay/program traza.txt [--list] [--verbose]
+//
+// La traza es la captura del volcado por Serial (comando 'T': líneas
+// "TRACE <hex>", el resto del log se ignora) o un binario de --record
+// (entornos native y sim). Cada cambio de entrada se aplica en su ms exacto
+// al pin y al debounce (InputSampler::inject), así que el firmware ve los
+// mismos flancos estables en el mismo instante que en la placa.
+//
+// Sale con 0 si todas las marcas coinciden y con 1 en la primera
+// divergencia (para git bisect run). --list imprime la traza decodificada.
+// Si AppBus perdió eventos (MARK_EVENTS_DROPPED), avisa y desde ahí
+// compara sólo las entradas.
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <vector>
+#include "hal/native/HostHal.hpp"
+#include "core/InputSampler.hpp"
+#include "core/InputTrace.hpp"
+#include "core/Scheduler.hpp"
+#include "core/Types.hpp"
+#include "app/AccessController.hpp"
+#include "TraceFile.hpp"
+
+void setup();
+extern SEMAFARO_TLS AccessController accessController;
+
+namespace {
+  using Record = InputTrace::Record;
+
+  const char* accessName(uint32_t s) {
+    static const char* const kNames[] = {"IDLE", "CHECK_CAPACITY", "OPENING", "WAIT_PASS",
+                                         "CLOSING", "FAULT"};
+    return s < sizeof(kNames) / sizeof(kNames[0]) ? kNames[s] : "?";
+  }
+
+  void describe(const Record& r, char* out, size_t len) {
+    if (r.isInput()) {
+      snprintf(out, len, "GPIO%u %s", r.pin(), r.level() ? "HIGH" : "LOW");
+      return;
+    }
+    switch (r.code) {
+      case InputTrace::MARK_ACCESS:
+        snprintf(out, len, "access -> %s", accessName(r.value));
+        break;
+      case InputTrace::MARK_BARRIER_OPENED: snprintf(out, len, "barrier opened"); break;
+      case InputTrace::MARK_BARRIER_CLOSED: snprintf(out, len, "barrier closed"); break;
+      case InputTrace::MARK_BARRIER_TIMEOUT:
+        snprintf(out, len, "barrier %s timeout",
+                 r.value == static_cast<uint32_t>(BarrierState::OPENING) ? "open" : "close");
+        break;
+      case InputTrace::MARK_SLOT_OCCUPIED: snprintf(out, len, "slot %u occupied", r.value); break;
+      case InputTrace::MARK_SLOT_FREED: snprintf(out, len, "slot %u freed", r.value); break;
+      case InputTrace::MARK_CAPACITY_FULL: snprintf(out, len, "capacity full (class %u)", r.value); break;
+      case InputTrace::MARK_FAULT: snprintf(out, len, "system fault"); break;
+      case InputTrace::MARK_RESET: snprintf(out, len, "manual reset"); break;
+      case InputTrace::MARK_EVENTS_DROPPED: snprintf(out, len, "%u events dropped", r.value); break;
+      default: snprintf(out, len, "mark 0x%02x %u", r.code, r.value); break;
+    }
+  }
+
+  std::vector<Record> decode(const uint8_t* data, size_t len) {
+    std::vector<Record> out;
+    InputTrace::Reader reader(data, len);
+    Record r;
+    while (reader.next(r)) out.push_back(r);
+    return out;
+  }
+
+  // Índice de la primera marca de eventos perdidos (size() si no hay)
+  size_t firstDrop(const std::vector<Record>& records) {
+    for (size_t i = 0; i < records.size(); i++) {
+      if (records[i].code == InputTrace::MARK_EVENTS_DROPPED) return i;
+    }
+    return records.size();
+  }
+
+  std::vector<Record> inputsFrom(const std::vector<Record>& records, size_t from) {
+    std::vector<Record> out;
+    for (size_t i = from; i < records.size(); i++) {
+      if (records[i].isInput()) out.push_back(records[i]);
+    }
+    return out;
+  }
+
+  void printRecord(const char* prefix, const Record& r) {
+    char text[48];
+    describe(r, text, sizeof(text));
+    fprintf(stderr, "%s%10.3f s  %s\n", prefix, r.tMs / 1000.0, text);
+  }
+}
+
+int main(int argc, char** argv) {
+  const char* path = nullptr;
+  bool list = false;
+  bool verbose = false;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--list") == 0) {
+      list = true;
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      verbose = true;
+    } else {
+      path = argv[i];
+    }
+  }
+
+  std::vector<uint8_t> file;
+  InputTrace::Header h;
+  if (!path || !TraceFile::load(path, file) ||
+      !InputTrace::decodeHeader(file.data(), file.size(), h)) {
+    fprintf(stderr, "usage: replay <trace file> [--list] [--verbose] (no valid trace read)\n");
+    return 2;
+  }
+  const uint8_t* body = file.data() + InputTrace::kHeaderBytes;
+  std::vector<Record> recorded = decode(body, h.bytes);
+
+  // Estímulos a aplicar: entradas y órdenes externas (MARK_RESET)
+  std::vector<Record> inputs;
+  size_t marks = 0;
+  for (const auto& r : recorded) {
+    if (r.isInput() || r.code == InputTrace::MARK_RESET) {
+      inputs.push_back(r);
+    } else {
+      marks++;
+    }
+  }
+  uint32_t spanMs = recorded.empty() ? 0 : recorded.back().tMs;
+  fprintf(stderr, "trace: %u bytes, %zu inputs, %zu marks, %.2f h%s\n", h.bytes, inputs.size(),
+          marks, spanMs / 3600000.0, h.dropped ? " (truncated: buffer full)" : "");
+  if (list) {
+    for (const auto& r : recorded) printRecord("  ", r);
+  }
+
+  uint8_t flags = (LOOP_MODE == LOOP_MODE_EVENT ? InputTrace::FLAG_LOOP_EVENT : 0) |
+                  (Cfg::kInputMode == Cfg::InputMode::EDGE ? InputTrace::FLAG_INPUT_EDGE : 0);
+  if (flags != h.flags) {
+    fprintf(stderr, "warning: trace recorded with LOOP_MODE/kInputMode flags 0x%02x, "
+                    "this build has 0x%02x\n", h.flags, flags);
+  }
+
+  // Niveles de arranque grabados y buffer propio para la traza de la reproducción
+  HostHal::setSerialEcho(verbose);
+  for (uint8_t pin = 0; pin < 64; pin++) {
+    if ((h.watched >> pin) & 1) HostHal::setInput(pin, (h.levels >> pin) & 1);
+  }
+  std::vector<uint8_t> replayBuf(h.bytes + h.bytes / 2 + 4096);
+  InputTrace::useBuffer(replayBuf.data(), replayBuf.size());
+
+  auto wall0 = std::chrono::steady_clock::now();
+  setup();
+  if (InputSampler::watched() != h.watched) {
+    fprintf(stderr, "warning: watched pins differ (trace %016llx, build %016llx)\n",
+            static_cast<unsigned long long>(h.watched),
+            static_cast<unsigned long long>(InputSampler::watched()));
+  }
+
+  const uint32_t originMs = InputTrace::startMs();
+  for (const auto& r : inputs) HostHal::scheduleWake((static_cast<uint64_t>(originMs) + r.tMs) * 1000);
+  HostHal::scheduleWake((static_cast<uint64_t>(originMs) + spanMs) * 1000);
+
+  // loop() en sus dos mitades: los cambios de entrada del instante se
+  // aplican antes del paso de control, como los aceptó el debounce en la
+  // placa; un reset, después (llega desde fuera, entre pasos)
+  size_t next = 0;
+  uint64_t loops = 0;
+  for (;;) {
+    uint32_t nowMs = millis() - originMs;
+    for (; next < inputs.size() && inputs[next].tMs <= nowMs && inputs[next].isInput(); next++) {
+      HostHal::setInput(inputs[next].pin(), inputs[next].level());
+      InputSampler::inject(inputs[next].pin(), inputs[next].level());
+    }
+    Scheduler::tick();
+    loops++;
+    for (; next < inputs.size() && inputs[next].tMs <= nowMs && !inputs[next].isInput(); next++) {
+      accessController.reset();
+    }
+    if (next == inputs.size() && nowMs >= spanMs) break;
+    Scheduler::sleepUntilNext();
+  }
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+
+  std::vector<Record> got = decode(replayBuf.data(), InputTrace::used());
+  fprintf(stderr, "replayed in %.3f s wall, %llu loop() iterations, %zu records\n", wallS,
+          static_cast<unsigned long long>(loops), got.size());
+
+  // Registro a registro (entradas incluidas: deben salir idénticas). Si la
+  // grabación se cortó, la reproducción puede tener de más al final
+  size_t common = recorded.size() < got.size() ? recorded.size() : got.size();
+  size_t strict = std::min(firstDrop(recorded), firstDrop(got));
+  for (size_t i = 0; i < common && i < strict; i++) {
+    const Record& a = recorded[i];
+    const Record& b = got[i];
+    if (a.tMs == b.tMs && a.code == b.code && a.value == b.value) continue;
+    fprintf(stderr, "DIVERGED at record %zu:\n", i);
+    printRecord("  recorded ", a);
+    printRecord("  replayed ", b);
+    return 1;
+  }
+
+  // AppBus perdió eventos: desde ahí faltan marcas en una traza o en la
+  // otra, y compararlas daría divergencias falsas. Sólo las entradas
+  // siguen siendo comparables
+  if (strict < common) {
+    const Record& drop = strict < recorded.size() && recorded[strict].code == InputTrace::MARK_EVENTS_DROPPED
+                             ? recorded[strict] : got[strict];
+    fprintf(stderr, "warning: event queue overflow at %.3f s (%u events dropped); "
+                    "comparing inputs only from record %zu\n", drop.tMs / 1000.0, drop.value, strict);
+    std::vector<Record> a = inputsFrom(recorded, strict);
+    std::vector<Record> b = inputsFrom(got, strict);
+    size_t n = std::min(a.size(), b.size());
+    for (size_t i = 0; i < n; i++) {
+      if (a[i].tMs == b[i].tMs && a[i].code == b[i].code) continue;
+      fprintf(stderr, "DIVERGED at input %zu after the overflow:\n", i);
+      printRecord("  recorded ", a[i]);
+      printRecord("  replayed ", b[i]);
+      return 1;
+    }
+    if (a.size() != b.size() && (b.size() < a.size() || !h.dropped)) {
+      fprintf(stderr, "DIVERGED: %zu inputs recorded after the overflow, %zu replayed\n",
+              a.size(), b.size());
+      return 1;
+    }
+    fprintf(stderr, "OK: %zu records match, then %zu inputs\n", strict, n);
+    return 0;
+  }
+
+  if (got.size() < recorded.size() || (got.size() > recorded.size() && !h.dropped)) {
+    fprintf(stderr, "DIVERGED: %zu records recorded, %zu replayed\n", recorded.size(), got.size());
+    const Record& extra = got.size() < recorded.size() ? recorded[common] : got[common];
+    printRecord(got.size() < recorded.size() ? "  missing  " : "  extra    ", extra);
+    return 1;
+  }
+  fprintf(stderr, "OK: %zu records match\n", common);
+  return 0;
+}
@@ -0,0 +1,38 @@
+// Simulador de tráfico (host/traffic/TrafficSim.hpp): una corrida con
+// reporte de throughput, rechazos por clase, demoras y uso por slot.
+//
+//   pio run -e sim && .pio/build/sim/program [--hours 168] [--seed 1] [--rate 1.0]
+//                                            [--trace archivo] [--record traza.bin]
+//                                            [--verbose]
+//
+// --trace reemplaza las llegadas Poisson por un guion de líneas
+// "<segundo> <VIP|CARGA|REGULAR> <estadía s>". --record guarda la traza de
+// entradas del firmware para host/replay. Para barrer parámetros con
+// muchas semillas, ver host/sweep.
+#include <stdlib.h>
+#include <string.h>
+#include "host/traffic/TrafficSim.hpp"
+
+int main(int argc, char** argv) {
+  TrafficSim::Params p;
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) {
+      p.hours = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+      p.seed = strtoull(argv[++i], nullptr, 10);
+    } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+      p.rate = atof(argv[++i]);
+    } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+      p.tracePath = argv[++i];
+    } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+      p.recordPath = argv[++i];
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      p.verbose = true;
+    }
+  }
+
+  TrafficSim::Result r;
+  if (!TrafficSim::run(p, r)) return 1;
+  TrafficSim::printReport(p, r);
+  return r.mismatches > 0 ? 1 : 0;
+}
@@ -0,0 +1,86 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Reparte los índices [0, n) entre hilos con robo de trabajo.
+//
+// Cada hilo arranca con un tramo contiguo [begin, end) guardado en una sola
+// palabra atómica. El dueño toma del principio; un hilo sin trabajo roba la
+// mitad final del tramo de otro. Las dos operaciones son un CAS sobre esa
+// palabra, así que no hay locks y cada índice corre exactamente una vez.
+// Las corridas largas (más tráfico, más horas) no dejan hilos ociosos al
+// final como un reparto fijo.
+class StealPool {
+public:
+  template <typename Fn>
+  static void run(uint32_t n, unsigned threads, Fn fn) {
+    if (threads == 0) threads = 1;
+    std::unique_ptr<Range[]> ranges(new Range[threads]);
+    for (unsigned t = 0; t < threads; t++) {
+      uint32_t begin = static_cast<uint32_t>(static_cast<uint64_t>(n) * t / threads);
+      uint32_t end = static_cast<uint32_t>(static_cast<uint64_t>(n) * (t + 1) / threads);
+      ranges[t].word.store(pack(begin, end), std::memory_order_relaxed);
+    }
+
+    std::vector<std::thread> workers;
+    for (unsigned t = 0; t < threads; t++) {
+      workers.emplace_back([&, t]() {
+        Range& own = ranges[t];
+        for (;;) {
+          uint32_t idx;
+          if (popFront(own, idx)) {
+            fn(idx);
+            continue;
+          }
+          // Sin trabajo propio: recorrer a los demás y robar
+          bool stolen = false;
+          for (unsigned k = 1; k < threads && !stolen; k++) {
+            stolen = stealHalf(ranges[(t + k) % threads], own);
+          }
+          if (!stolen) return;   // Todo tomado (lo que queda, lo termina su dueño)
+        }
+      });
+    }
+    for (auto& w : workers) w.join();
+  }
+
+private:
+  struct alignas(64) Range {
+    std::atomic<uint64_t> word{0};
+  };
+
+  static uint64_t pack(uint32_t begin, uint32_t end) {
+    return (static_cast<uint64_t>(begin) << 32) | end;
+  }
+
+  static bool popFront(Range& r, uint32_t& idx) {
+    uint64_t w = r.word.load(std::memory_order_acquire);
+    for (;;) {
+      uint32_t begin = static_cast<uint32_t>(w >> 32);
+      uint32_t end = static_cast<uint32_t>(w);
+      if (begin >= end) return false;
+      if (r.word.compare_exchange_weak(w, pack(begin + 1, end), std::memory_order_acq_rel)) {
+        idx = begin;
+        return true;
+      }
+    }
+  }
+
+  // Deja a la víctima [begin, mid) y pasa [mid, end) al tramo propio (vacío)
+  static bool stealHalf(Range& victim, Range& own) {
+    uint64_t w = victim.word.load(std::memory_order_acquire);
+    for (;;) {
+      uint32_t begin = static_cast<uint32_t>(w >> 32);
+      uint32_t end = static_cast<uint32_t>(w);
+      if (begin >= end) return false;
+      uint32_t mid = begin + (end - begin) / 2;
+      if (victim.word.compare_exchange_weak(w, pack(begin, mid), std::memory_order_acq_rel)) {
+        own.word.store(pack(mid, end), std::memory_order_release);
+        return true;
+      }
+    }
+  }
+};
@@ -0,0 +1,305 @@
+// Barrido Monte Carlo de tiempos de la barrera (Cfg::GateTiming) sobre el
+// simulador de tráfico (host/traffic/TrafficSim.hpp).
+//
+//   pio run -e sweep && .pio/build/sweep/program [--pass 2000,3000,4000]
+//       [--open 5000] [--close 3000] [--move 600] [--rate 1.0,1.5]
+//       [--seeds 200] [--hours 168] [--threads N] [--seed-base 1]
+//
+// Cada lista separada por comas es un eje; la grilla es su producto
+// cartesiano y cada punto corre --seeds semanas simuladas. La semilla de la
+// corrida k es splitmix64(seed-base + k) en todos los puntos (números
+// aleatorios comunes): las diferencias entre filas vienen de los parámetros,
+// no del azar. El resultado no depende de --threads.
+//
+// timeouts/1k: vencimientos de --pass (la barrera cierra sin ver el paso)
+// por cada 1000 ciclos. faults/1k: entradas a FAULT, que TrafficSim resetea
+// como un operador; una corrida puede sumar varias.
+//
+// Fallback de clases, política de slot y kMainUpdateMs se resuelven en
+// compilación (app/SlotPolicy.hpp, core/Config.hpp): el encabezado los
+// muestra y para compararlos hace falta un build por valor.
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <vector>
+#include "StealPool.hpp"
+#include "host/traffic/TrafficSim.hpp"
+
+namespace {
+  using TrafficSim::kClasses;
+
+  // Histograma log-lineal con contadores atómicos: valores < 32 exactos y
+  // de ahí 16 subdivisiones por potencia de 2 (error relativo < 6.25%).
+  // Sumar en cualquier orden da el mismo resultado: el reporte no depende
+  // de qué hilo corrió qué semilla.
+  class AtomicHistogram {
+  public:
+    void add(uint32_t v) {
+      counts_[bucket(v)].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    uint64_t total() const {
+      uint64_t n = 0;
+      for (const auto& c : counts_) n += c.load(std::memory_order_relaxed);
+      return n;
+    }
+
+    // Límite superior del bucket que contiene el percentil q (0..1)
+    uint32_t percentile(double q) const {
+      uint64_t n = total();
+      if (n == 0) return 0;
+      uint64_t rank = static_cast<uint64_t>(q * (n - 1)) + 1;
+      uint64_t seen = 0;
+      for (size_t i = 0; i < kBuckets; i++) {
+        seen += counts_[i].load(std::memory_order_relaxed);
+        if (seen >= rank) return upper(i);
+      }
+      return upper(kBuckets - 1);
+    }
+
+  private:
+    static constexpr unsigned kSubBits = 4;
+    static constexpr uint32_t kLinear = 1u << (kSubBits + 1);   // 32
+    static constexpr size_t kBuckets = kLinear + (31 - kSubBits) * (1u << kSubBits);
+
+    static size_t bucket(uint32_t v) {
+      if (v < kLinear) return v;
+      unsigned msb = 31 - __builtin_clz(v);
+      uint32_t sub = (v >> (msb - kSubBits)) & ((1u << kSubBits) - 1);
+      return kLinear + (msb - kSubBits - 1) * (1u << kSubBits) + sub;
+    }
+
+    static uint32_t upper(size_t i) {
+      if (i < kLinear) return static_cast<uint32_t>(i);
+      size_t k = i - kLinear;
+      unsigned msb = static_cast<unsigned>(k >> kSubBits) + kSubBits + 1;
+      uint64_t sub = k & ((1u << kSubBits) - 1);
+      uint64_t hi = ((1ull << kSubBits) + sub + 1) << (msb - kSubBits);
+      return static_cast<uint32_t>(hi > 0xFFFFFFFFull ? 0xFFFFFFFFull : hi - 1);
+    }
+
+    std::atomic<uint64_t> counts_[kBuckets]{};
+  };
+
+  struct Point {
+    Cfg::GateTiming timing;
+    double rate;
+  };
+
+  // Acumulado de un punto de la grilla. Lo escriben todos los hilos con
+  // fetch_add relajado; sólo se lee después del join
+  struct Totals {
+    std::atomic<uint64_t> runs{0};
+    std::atomic<uint64_t> arrivals[kClasses]{};
+    std::atomic<uint64_t> entered[kClasses]{};
+    std::atomic<uint64_t> denied[kClasses]{};
+    std::atomic<uint64_t> balked[kClasses]{};
+    std::atomic<uint64_t> exited{0};
+    std::atomic<uint64_t> cycles{0};
+    std::atomic<uint64_t> passTimeouts{0};
+    std::atomic<uint64_t> faults{0};
+    std::atomic<uint64_t> mismatches{0};
+    std::atomic<uint64_t> simUs{0};
+    AtomicHistogram entryWaitMs;     // Llegada -> acceso concedido, todas las clases
+    AtomicHistogram exitWaitMs;
+    AtomicHistogram cycleMsPerRun;   // Ciclo medio de cada corrida
+    AtomicHistogram perHourX10;      // Vehículos/h de cada corrida (x10)
+  };
+
+  uint64_t splitmix64(uint64_t x) {
+    x += 0x9E3779B97F4A7C15ull;
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    return x ^ (x >> 31);
+  }
+
+  template <typename T>
+  bool parseList(const char* s, std::vector<T>& out) {
+    out.clear();
+    while (*s) {
+      char* end;
+      double v = strtod(s, &end);
+      if (end == s) return false;
+      out.push_back(static_cast<T>(v));
+      s = (*end == ',') ? end + 1 : end;
+    }
+    return !out.empty();
+  }
+
+  const char* pickName(Cfg::SlotPick p) {
+    switch (p) {
+      case Cfg::SlotPick::FIRST_FREE:   return "FIRST_FREE";
+      case Cfg::SlotPick::NEAREST_GATE: return "NEAREST_GATE";
+      case Cfg::SlotPick::LEAST_RECENT: return "LEAST_RECENT";
+      case Cfg::SlotPick::LEVEL_FILL:   return "LEVEL_FILL";
+    }
+    return "?";
+  }
+
+  void accumulate(Totals& t, const TrafficSim::Result& r, uint32_t hours) {
+    t.runs.fetch_add(1, std::memory_order_relaxed);
+    uint64_t served = r.exited;
+    for (size_t c = 0; c < kClasses; c++) {
+      const auto& cr = r.classes[c];
+      t.arrivals[c].fetch_add(cr.arrivals, std::memory_order_relaxed);
+      t.entered[c].fetch_add(cr.entered, std::memory_order_relaxed);
+      t.denied[c].fetch_add(cr.denied, std::memory_order_relaxed);
+      t.balked[c].fetch_add(cr.balked, std::memory_order_relaxed);
+      for (uint32_t w : cr.waitMs) t.entryWaitMs.add(w);
+      served += cr.entered;
+    }
+    for (uint32_t w : r.exitWaitMs) t.exitWaitMs.add(w);
+    t.exited.fetch_add(r.exited, std::memory_order_relaxed);
+    t.cycles.fetch_add(r.gate.cycles, std::memory_order_relaxed);
+    t.passTimeouts.fetch_add(r.gate.passTimeouts, std::memory_order_relaxed);
+    t.faults.fetch_add(r.faults, std::memory_order_relaxed);
+    t.mismatches.fetch_add(r.mismatches, std::memory_order_relaxed);
+    t.simUs.fetch_add(r.spanUs, std::memory_order_relaxed);
+    if (r.gate.cycles > 0) {
+      t.cycleMsPerRun.add(static_cast<uint32_t>(r.gate.totalCycleMs / r.gate.cycles));
+    }
+    t.perHourX10.add(static_cast<uint32_t>(served * 10 / (hours ? hours : 1)));
+  }
+
+  double pct(uint64_t part, uint64_t whole) {
+    return whole ? 100.0 * static_cast<double>(part) / static_cast<double>(whole) : 0.0;
+  }
+}
+
+int main(int argc, char** argv) {
+  std::vector<uint32_t> passMs{Cfg::kPassTimeMs};
+  std::vector<uint32_t> openMs{Cfg::kOpenTimeout};
+  std::vector<uint32_t> closeMs{Cfg::kCloseTimeout};
+  std::vector<uint32_t> moveMs{Cfg::kBarrierMoveMs};
+  std::vector<double> rates{1.0};
+  uint32_t seeds = 200;
+  uint32_t hours = 24 * 7;
+  uint64_t seedBase = 1;
+  unsigned threads = std::thread::hardware_concurrency();
+
+  for (int i = 1; i < argc; i++) {
+    bool ok = true;
+    if (strcmp(argv[i], "--pass") == 0 && i + 1 < argc) {
+      ok = parseList(argv[++i], passMs);
+    } else if (strcmp(argv[i], "--open") == 0 && i + 1 < argc) {
+      ok = parseList(argv[++i], openMs);
+    } else if (strcmp(argv[i], "--close") == 0 && i + 1 < argc) {
+      ok = parseList(argv[++i], closeMs);
+    } else if (strcmp(argv[i], "--move") == 0 && i + 1 < argc) {
+      ok = parseList(argv[++i], moveMs);
+    } else if (strcmp(argv[i], "--rate") == 0 && i + 1 < argc) {
+      ok = parseList(argv[++i], rates);
+    } else if (strcmp(argv[i], "--seeds") == 0 && i + 1 < argc) {
+      seeds = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--hours") == 0 && i + 1 < argc) {
+      hours = static_cast<uint32_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+      threads = static_cast<unsigned>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--seed-base") == 0 && i + 1 < argc) {
+      seedBase = strtoull(argv[++i], nullptr, 10);
+    } else {
+      ok = false;
+    }
+    if (!ok) {
+      fprintf(stderr, "bad argument: %s\n", argv[i]);
+      return 2;
+    }
+  }
+  if (threads == 0) threads = 1;
+  if (seeds == 0) seeds = 1;
+
+  std::vector<Point> grid;
+  for (uint32_t pass : passMs)
+    for (uint32_t open : openMs)
+      for (uint32_t close : closeMs)
+        for (uint32_t move : moveMs)
+          for (double rate : rates)
+            grid.push_back({{pass, open, close, move}, rate});
+
+  uint64_t jobs64 = static_cast<uint64_t>(grid.size()) * seeds;
+  if (jobs64 > 0xFFFFFFFFull) {
+    fprintf(stderr, "grid too large: %llu runs\n", static_cast<unsigned long long>(jobs64));
+    return 2;
+  }
+  uint32_t jobs = static_cast<uint32_t>(jobs64);
+  std::unique_ptr<Totals[]> totals(new Totals[grid.size()]);
+
+  fprintf(stderr, "sweep: %zu points x %u seeds x %u h on %u threads\n",
+          grid.size(), seeds, hours, threads);
+  fprintf(stderr, "compile-time: pick %s, fallback %s, VIP fallback %s, main update %u ms\n",
+          pickName(Cfg::kSlotPick),
+          Cfg::kClassFallback == Cfg::ClassFallback::VIP_ONLY ? "VIP_ONLY" : "REGULAR_TO_CARGA",
+          Cfg::kVipFallback == Cfg::VipFallbackPolicy::CARGA_THEN_REGULAR
+              ? "CARGA_THEN_REGULAR" : "REGULAR_THEN_CARGA",
+          static_cast<unsigned>(Cfg::kMainUpdateMs));
+
+  auto t0 = std::chrono::steady_clock::now();
+  StealPool::run(jobs, threads, [&](uint32_t job) {
+    size_t point = job / seeds;
+    TrafficSim::Params p;
+    p.hours = hours;
+    p.seed = splitmix64(seedBase + job % seeds);
+    p.rate = grid[point].rate;
+    p.timing = grid[point].timing;
+
+    // El firmware es estado thread_local (SEMAFARO_TLS) que setup() no
+    // reinicia: cada corrida en un hilo nuevo arranca de cero, como
+    // después de un reset. Crear el hilo cuesta mucho menos que la semana
+    TrafficSim::Result r;
+    std::thread run([&]() { TrafficSim::run(p, r); });
+    run.join();
+    accumulate(totals[point], r, hours);
+  });
+  double wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+  uint64_t simH = 0;
+  for (size_t i = 0; i < grid.size(); i++) simH += totals[i].simUs.load() / 3600000000ull;
+  fprintf(stderr, "%u runs in %.2f s wall (%.1f runs/s, %llu simulated h)\n\n",
+          jobs, wallS, wallS > 0 ? jobs / wallS : 0.0, static_cast<unsigned long long>(simH));
+
+  fprintf(stderr, " pass  open close move rate |  veh/h p50   p5  | denied%% balked%% | "
+                  "wait ms p50   p95   p99 | exit p99 | cycle p50 | timeouts/1k faults/1k\n");
+  uint64_t mismatches = 0;
+  for (size_t i = 0; i < grid.size(); i++) {
+    const Point& g = grid[i];
+    Totals& t = totals[i];
+    uint64_t arrivals = 0, denied = 0, balked = 0;
+    for (size_t c = 0; c < kClasses; c++) {
+      arrivals += t.arrivals[c].load();
+      denied += t.denied[c].load();
+      balked += t.balked[c].load();
+    }
+    uint64_t cycles = t.cycles.load();
+    mismatches += t.mismatches.load();
+    fprintf(stderr, "%5u %5u %5u %4u %4.2f | %10.1f %5.1f | %6.2f%% %6.2f%% | "
+                    "%11u %5u %5u | %8u | %9u | %11.2f %9.2f\n",
+            g.timing.passTimeMs, g.timing.openTimeoutMs, g.timing.closeTimeoutMs, g.timing.moveMs,
+            g.rate,
+            t.perHourX10.percentile(0.50) / 10.0, t.perHourX10.percentile(0.05) / 10.0,
+            pct(denied, arrivals), pct(balked, arrivals),
+            t.entryWaitMs.percentile(0.50), t.entryWaitMs.percentile(0.95),
+            t.entryWaitMs.percentile(0.99), t.exitWaitMs.percentile(0.99),
+            t.cycleMsPerRun.percentile(0.50),
+            cycles ? 1000.0 * t.passTimeouts.load() / cycles : 0.0,
+            cycles ? 1000.0 * t.faults.load() / cycles : 0.0);
+  }
+
+  fprintf(stderr, "\nper class denied%% (VIP / CARGA / REGULAR):\n");
+  for (size_t i = 0; i < grid.size(); i++) {
+    Totals& t = totals[i];
+    fprintf(stderr, "  #%-3zu", i);
+    for (size_t c = 0; c < kClasses; c++) {
+      fprintf(stderr, " %7.2f%%", pct(t.denied[c].load(), t.arrivals[c].load()));
+    }
+    fprintf(stderr, "\n");
+  }
+  if (mismatches > 0) {
+    fprintf(stderr, "\n%llu grants to a class other than the lane front\n",
+            static_cast<unsigned long long>(mismatches));
+  }
+  return mismatches > 0 ? 1 : 0;
+}
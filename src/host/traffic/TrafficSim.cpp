@@ -0,0 +1,425 @@
+#include "TrafficSim.hpp"
+#include <Arduino.h>
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <queue>
+#include <random>
+#include "hal/native/HostHal.hpp"
+#include "core/Pins.hpp"
+#include "core/Scheduler.hpp"
+#include "devices/Barrier.hpp"
+#include "host/replay/TraceFile.hpp"
+
+void setup();
+extern SEMAFARO_TLS AccessController accessController;
+extern SEMAFARO_TLS Barrier barrier;
+
+namespace TrafficSim {
+  const char* const kClassName[kClasses] = {"VIP", "CARGA", "REGULAR"};
+}
+
+namespace {
+  using TrafficSim::kClasses;
+  constexpr uint8_t kClassButton[kClasses] = {Pins::BTN_VIP_IN, Pins::BTN_CARGA_IN, Pins::BTN_REG_IN};
+
+  // Llegadas por hora en la hora de mayor demanda y estadía media por clase
+  constexpr double kPeakPerHour[kClasses] = {1.0, 1.5, 4.0};
+  constexpr double kMeanDwellMin[kClasses] = {240.0, 45.0, 120.0};
+
+  // Demanda relativa por hora del día (pico de entrada a las 8, de salida
+  // a las 17); sábado y domingo, escalada por kWeekendFactor
+  constexpr double kDayCurve[24] = {
+    0.05, 0.03, 0.02, 0.02, 0.03, 0.10, 0.35, 0.80, 1.00, 0.85, 0.60, 0.55,
+    0.60, 0.55, 0.50, 0.55, 0.70, 0.90, 0.75, 0.45, 0.30, 0.20, 0.12, 0.08,
+  };
+  constexpr double kWeekendFactor = 0.4;
+
+  // Tiempos del conductor (ms). Reacción y cruce son medianas: cada
+  // conductor las escala por un factor log-normal (kDriverSpread)
+  constexpr uint32_t kPressMs = 200;       // Botón pulsado
+  constexpr uint32_t kReactMs = 800;       // Barrera abierta -> empieza a cruzar
+  constexpr uint32_t kCrossMs = 1500;      // Sensor de seguridad activo al cruzar
+  constexpr double kDriverSpread = 0.15;   // Desvío del log del factor
+  constexpr uint32_t kPullUpMs = 1000;     // El siguiente de la fila llega al botón
+  constexpr uint32_t kToSlotMs = 20000;    // Barrera -> slot (antes de kSlotReserveMs)
+  constexpr uint32_t kToExitMs = 30000;    // Slot -> fila de salida
+  constexpr uint32_t kMinDwellMs = 300000;
+  constexpr size_t kLaneCapacity = 8;      // Vehículos que caben esperando en la calle
+
+  constexpr uint64_t msToUs(uint64_t ms) { return ms * 1000; }
+
+  struct Car {
+    VehicleClass vc;
+    uint64_t dwellUs;
+    uint32_t reactMs;
+    uint32_t crossMs;
+    uint64_t laneUs{0};    // Llegada a la fila actual
+    int slot{-1};
+  };
+
+  // Fila delante de un botón: el primero pulsa, espera acceso y la barrera
+  struct Lane {
+    enum class Front : uint8_t { NONE, PRESSED, GRANTED };
+    std::deque<size_t> cars;
+    Front front{Front::NONE};
+    uint64_t readyUs{0};   // Desde cuándo el primero puede pulsar
+  };
+
+  struct SimEvent {
+    enum Kind : uint8_t { ARRIVE, JOIN_EXIT, PRESS } kind;
+    uint64_t atUs;
+    size_t car;           // ARRIVE/JOIN_EXIT: vehículo; PRESS: 0 entrada, 1 salida
+    bool operator>(const SimEvent& o) const { return atUs > o.atUs; }
+  };
+
+  class Simulation {
+  public:
+    Simulation(const TrafficSim::Params& p, TrafficSim::Result& r) : p_(p), r_(r), rng_(p.seed) {}
+
+    bool run();
+
+  private:
+    void push(SimEvent::Kind kind, uint64_t atUs, size_t car);
+    void addCar(VehicleClass vc, uint64_t atUs, uint64_t dwellUs);
+    void countServed(uint64_t atUs);
+    void pressIfReady(Lane& lane, bool exit, uint64_t nowUs);
+    void join(Lane& lane, bool exit, size_t car, uint64_t nowUs);
+    void advanceLane(Lane& lane, bool exit, uint64_t fromUs);
+    void runEvents(uint64_t nowUs);
+    void crossIfOpen(Lane& lane, bool exit, uint64_t nowUs);
+    void observe(uint64_t nowUs);
+    bool loadTrace(const char* path);
+    void generateArrivals();
+
+    const TrafficSim::Params& p_;
+    TrafficSim::Result& r_;
+    std::mt19937_64 rng_;
+    std::vector<Car> cars_;
+    std::priority_queue<SimEvent, std::vector<SimEvent>, std::greater<SimEvent>> events_;
+    Lane entry_, exit_;
+    AccessController::Stats seen_;
+    uint64_t startUs_{0};
+    uint64_t endUs_{0};
+  };
+
+  void Simulation::push(SimEvent::Kind kind, uint64_t atUs, size_t car) {
+    events_.push({kind, atUs, car});
+    HostHal::scheduleWake(atUs);
+  }
+
+  void Simulation::addCar(VehicleClass vc, uint64_t atUs, uint64_t dwellUs) {
+    std::lognormal_distribution<double> driver(0.0, kDriverSpread);
+    uint32_t reactMs = static_cast<uint32_t>(kReactMs * driver(rng_));
+    uint32_t crossMs = static_cast<uint32_t>(kCrossMs * driver(rng_));
+    cars_.push_back({vc, dwellUs, reactMs, crossMs});
+    push(SimEvent::ARRIVE, atUs, cars_.size() - 1);
+  }
+
+  void Simulation::countServed(uint64_t atUs) {
+    size_t hour = static_cast<size_t>((atUs - startUs_) / msToUs(3600000));
+    if (hour < r_.servedPerHour.size()) r_.servedPerHour[hour]++;
+  }
+
+  // El primero de la fila pulsa en cuanto llegó al botón
+  void Simulation::pressIfReady(Lane& lane, bool exit, uint64_t nowUs) {
+    if (lane.cars.empty() || lane.front != Lane::Front::NONE) return;
+    if (lane.readyUs > nowUs) {
+      push(SimEvent::PRESS, lane.readyUs, exit ? 1 : 0);
+      return;
+    }
+    uint8_t pin = exit ? Pins::BTN_EXIT : kClassButton[static_cast<size_t>(cars_[lane.cars.front()].vc)];
+    HostHal::scheduleInput(nowUs, pin, false);
+    HostHal::scheduleInput(nowUs + msToUs(kPressMs), pin, true);
+    lane.front = Lane::Front::PRESSED;
+  }
+
+  void Simulation::join(Lane& lane, bool exit, size_t car, uint64_t nowUs) {
+    cars_[car].laneUs = nowUs;
+    lane.cars.push_back(car);
+    pressIfReady(lane, exit, nowUs);
+  }
+
+  // El primero deja su lugar: el siguiente llega al botón en kPullUpMs
+  void Simulation::advanceLane(Lane& lane, bool exit, uint64_t fromUs) {
+    lane.cars.pop_front();
+    lane.front = Lane::Front::NONE;
+    lane.readyUs = fromUs + msToUs(kPullUpMs);
+    pressIfReady(lane, exit, fromUs);
+  }
+
+  void Simulation::runEvents(uint64_t nowUs) {
+    while (!events_.empty() && events_.top().atUs <= nowUs) {
+      SimEvent ev = events_.top();
+      events_.pop();
+      switch (ev.kind) {
+        case SimEvent::ARRIVE: {
+          TrafficSim::ClassResult& cs = r_.classes[static_cast<size_t>(cars_[ev.car].vc)];
+          cs.arrivals++;
+          if (entry_.cars.size() >= kLaneCapacity) {
+            cs.balked++;
+          } else {
+            join(entry_, false, ev.car, nowUs);
+          }
+          break;
+        }
+        case SimEvent::JOIN_EXIT:
+          join(exit_, true, ev.car, nowUs);
+          break;
+        case SimEvent::PRESS:
+          pressIfReady(ev.car ? exit_ : entry_, ev.car != 0, nowUs);
+          break;
+      }
+    }
+  }
+
+  // Con la barrera abierta, el primero con acceso concedido cruza
+  void Simulation::crossIfOpen(Lane& lane, bool exit, uint64_t nowUs) {
+    if (lane.front != Lane::Front::GRANTED || !barrier.isOpen()) return;
+    size_t id = lane.cars.front();
+    Car& car = cars_[id];
+    uint64_t crossUs = nowUs + msToUs(car.reactMs);
+    uint64_t clearUs = crossUs + msToUs(car.crossMs);
+    HostHal::scheduleInput(crossUs, Pins::BARRIER_SAFE_IN, true);
+    HostHal::scheduleInput(clearUs, Pins::BARRIER_SAFE_IN, false);
+
+    if (exit) {
+      r_.exited++;
+    } else {
+      // Estaciona, se queda su estadía y vuelve hacia la salida
+      uint64_t parkUs = clearUs + msToUs(kToSlotMs);
+      uint64_t leaveUs = parkUs + car.dwellUs;
+      uint8_t pin = ParkingLayout::kSlots[car.slot].sensorPin;
+      HostHal::scheduleInput(parkUs, pin, true);
+      HostHal::scheduleInput(leaveUs, pin, false);
+      push(SimEvent::JOIN_EXIT, leaveUs + msToUs(kToExitMs), id);
+
+      TrafficSim::SlotResult& use = r_.slots[car.slot];
+      use.parks++;
+      use.reservedUs += std::min(parkUs, endUs_) - std::min(nowUs, endUs_);
+      use.occupiedUs += std::min(leaveUs, endUs_) - std::min(parkUs, endUs_);
+    }
+    advanceLane(lane, exit, crossUs);
+  }
+
+  // Después de cada paso: qué resolvió el firmware
+  void Simulation::observe(uint64_t nowUs) {
+    const auto& st = accessController.stats();
+
+    if (st.entries != seen_.entries && !entry_.cars.empty()) {
+      Car& car = cars_[entry_.cars.front()];
+      if (accessController.getPendingClass() != car.vc) r_.mismatches++;
+      car.slot = accessController.getAssignedSlot();
+      TrafficSim::ClassResult& cs = r_.classes[static_cast<size_t>(car.vc)];
+      cs.entered++;
+      cs.waitMs.push_back(static_cast<uint32_t>((nowUs - car.laneUs) / 1000));
+      entry_.front = Lane::Front::GRANTED;
+      countServed(nowUs);
+    }
+    if (st.exits != seen_.exits && !exit_.cars.empty()) {
+      r_.exitWaitMs.push_back(static_cast<uint32_t>((nowUs - cars_[exit_.cars.front()].laneUs) / 1000));
+      exit_.front = Lane::Front::GRANTED;
+      countServed(nowUs);
+    }
+    if (st.denied != seen_.denied && !entry_.cars.empty()) {
+      r_.classes[static_cast<size_t>(cars_[entry_.cars.front()].vc)].denied++;
+      advanceLane(entry_, false, nowUs);
+    }
+    seen_ = st;
+
+    crossIfOpen(entry_, false, nowUs);
+    crossIfOpen(exit_, true, nowUs);
+
+    // Falla (p. ej. la barrera cerró sobre un conductor lento): reset como
+    // un operador; los pedidos en cola se descartan, así que los que
+    // esperaban vuelven a pulsar
+    if (accessController.isFault()) {
+      r_.faults++;
+      accessController.reset();
+      for (Lane* lane : {&entry_, &exit_}) {
+        lane->front = Lane::Front::NONE;
+        pressIfReady(*lane, lane == &exit_, nowUs);
+      }
+    }
+  }
+
+  bool parseClass(const char* s, VehicleClass& vc) {
+    for (size_t c = 0; c < kClasses; c++) {
+      if (strcmp(s, TrafficSim::kClassName[c]) == 0) {
+        vc = static_cast<VehicleClass>(c);
+        return true;
+      }
+    }
+    return false;
+  }
+
+  bool Simulation::loadTrace(const char* path) {
+    FILE* f = fopen(path, "r");
+    if (!f) {
+      fprintf(stderr, "cannot open trace %s\n", path);
+      return false;
+    }
+    char line[128];
+    unsigned lineNo = 0;
+    while (fgets(line, sizeof(line), f)) {
+      lineNo++;
+      if (line[0] == '#' || line[0] == '\n') continue;
+      double atS, dwellS;
+      char cls[16];
+      VehicleClass vc;
+      if (sscanf(line, "%lf %15s %lf", &atS, cls, &dwellS) != 3 || !parseClass(cls, vc)) {
+        fprintf(stderr, "%s:%u: expected '<seconds> <VIP|CARGA|REGULAR> <dwell s>'\n", path, lineNo);
+        fclose(f);
+        return false;
+      }
+      addCar(vc, startUs_ + static_cast<uint64_t>(atS * 1e6), static_cast<uint64_t>(dwellS * 1e6));
+    }
+    fclose(f);
+    return true;
+  }
+
+  // Poisson no homogéneo: tasa constante por hora, el intervalo exponencial
+  // se vuelve a sortear al cruzar de hora (sin memoria)
+  void Simulation::generateArrivals() {
+    std::uniform_real_distribution<double> u(0.0, 1.0);
+    for (size_t c = 0; c < kClasses; c++) {
+      std::exponential_distribution<double> dwell(1.0 / (kMeanDwellMin[c] * 60.0));
+      double t = 0;
+      for (uint32_t h = 0; h < p_.hours; h++) {
+        double factor = (h / 24) % 7 >= 5 ? kWeekendFactor : 1.0;
+        double perS = kPeakPerHour[c] * kDayCurve[h % 24] * factor * p_.rate / 3600.0;
+        if (t < h * 3600.0) t = h * 3600.0;
+        while (perS > 0) {
+          double next = t - log(1.0 - u(rng_)) / perS;
+          if (next >= (h + 1) * 3600.0) break;
+          t = next;
+          uint64_t dwellUs = msToUs(kMinDwellMs) + static_cast<uint64_t>(dwell(rng_) * 1e6);
+          addCar(static_cast<VehicleClass>(c), startUs_ + static_cast<uint64_t>(t * 1e6), dwellUs);
+        }
+      }
+    }
+  }
+
+  bool Simulation::run() {
+    HostHal::setSerialEcho(p_.verbose);
+
+    // Estado eléctrico de reposo: botones sin pulsar, sensores sin detección
+    for (uint8_t pin : {Pins::BTN_VIP_IN, Pins::BTN_CARGA_IN, Pins::BTN_REG_IN, Pins::BTN_EXIT}) {
+      HostHal::setInput(pin, true);
+    }
+    HostHal::setInput(Pins::BARRIER_SAFE_IN, false);
+    for (const auto& spec : ParkingLayout::kSlots) HostHal::setInput(spec.sensorPin, false);
+
+    // La traza de una semana no entra en la RAM interna (Cfg::kTraceBytes)
+    std::vector<uint8_t> traceBuf(p_.recordPath ? Cfg::kTracePsramBytes : 0);
+    if (p_.recordPath) InputTrace::useBuffer(traceBuf.data(), traceBuf.size());
+
+    auto wall0 = std::chrono::steady_clock::now();
+    setup();
+    barrier.setTiming(p_.timing);
+    accessController.setTiming(p_.timing);
+
+    // El día 0 empieza a las 00:00 al terminar setup()
+    startUs_ = HostHal::nowUs();
+    endUs_ = startUs_ + msToUs(static_cast<uint64_t>(p_.hours) * 3600000);
+    r_.spanUs = endUs_ - startUs_;
+    r_.servedPerHour.assign(p_.hours + 1, 0);
+    if (p_.tracePath) {
+      if (!loadTrace(p_.tracePath)) return false;
+    } else {
+      generateArrivals();
+    }
+
+    // loop() en sus dos mitades: el conductor reacciona a lo que hizo el
+    // paso antes de que el firmware se duerma
+    while (HostHal::nowUs() < endUs_) {
+      runEvents(HostHal::nowUs());
+      Scheduler::tick();
+      observe(HostHal::nowUs());
+      Scheduler::sleepUntilNext();
+      r_.loops++;
+    }
+
+    r_.wallS = std::chrono::duration<double>(std::chrono::steady_clock::now() - wall0).count();
+    r_.vehicles = cars_.size();
+    r_.exitPending = static_cast<uint32_t>(exit_.cars.size());
+    r_.gate = accessController.stats();
+    r_.queue = accessController.queue().stats();
+    r_.queueAvgWaitMs = accessController.queue().avgWaitMs();
+    if (p_.recordPath && !TraceFile::save(p_.recordPath)) {
+      fprintf(stderr, "cannot write %s\n", p_.recordPath);
+      return false;
+    }
+    return true;
+  }
+
+  struct WaitSummary {
+    double avgMs;
+    uint32_t p95Ms;
+    uint32_t maxMs;
+  };
+
+  WaitSummary summarize(std::vector<uint32_t>& waits) {
+    if (waits.empty()) return {0, 0, 0};
+    std::sort(waits.begin(), waits.end());
+    uint64_t total = 0;
+    for (uint32_t w : waits) total += w;
+    return {static_cast<double>(total) / waits.size(), waits[waits.size() * 95 / 100], waits.back()};
+  }
+}
+
+bool TrafficSim::run(const Params& p, Result& out) {
+  out = Result{};
+  return Simulation(p, out).run();
+}
+
+void TrafficSim::printReport(const Params& p, Result& r) {
+  const auto& st = r.gate;
+  fprintf(stderr, "simulated %u h (%s) in %.2f s wall, %llu loop() iterations, %zu vehicles\n",
+          p.hours, p.tracePath ? p.tracePath : "stochastic", r.wallS,
+          static_cast<unsigned long long>(r.loops), r.vehicles);
+
+  uint32_t peakHour = 0;
+  for (uint32_t n : r.servedPerHour) peakHour = std::max(peakHour, n);
+  fprintf(stderr, "throughput: %u entries, %u exits; %.1f vehicles/h avg, %u in the busiest hour\n",
+          st.entries, st.exits, p.hours ? (st.entries + st.exits) / static_cast<double>(p.hours) : 0.0,
+          peakHour);
+
+  fprintf(stderr, "%-8s | %8s %8s %8s %8s | %7s | %9s %8s %8s\n",
+          "class", "arrived", "entered", "denied", "balked", "denied%", "wait avg", "p95", "max");
+  for (size_t c = 0; c < kClasses; c++) {
+    ClassResult& cs = r.classes[c];
+    WaitSummary w = summarize(cs.waitMs);
+    fprintf(stderr, "%-8s | %8u %8u %8u %8u | %6.1f%% | %7.1f s %6.1f s %6.1f s\n",
+            kClassName[c], cs.arrivals, cs.entered, cs.denied, cs.balked,
+            cs.arrivals ? 100.0 * (cs.denied + cs.balked) / cs.arrivals : 0.0,
+            w.avgMs / 1000.0, w.p95Ms / 1000.0, w.maxMs / 1000.0);
+  }
+  WaitSummary xw = summarize(r.exitWaitMs);
+  fprintf(stderr, "%-8s | %8zu %8u %8s %8u | %7s | %7.1f s %6.1f s %6.1f s\n",
+          "EXIT", r.exitWaitMs.size() + r.exitPending, r.exited, "-", r.exitPending, "-",
+          xw.avgMs / 1000.0, xw.p95Ms / 1000.0, xw.maxMs / 1000.0);
+
+  fprintf(stderr, "firmware queue: max depth %u, wait avg %u ms, max %u ms; %u arrived busy, %u dropped\n",
+          r.queue.maxDepth, r.queueAvgWaitMs, r.queue.maxWaitMs, st.arrivedBusy, r.queue.dropped);
+  fprintf(stderr, "gate: %u cycles, avg %.0f ms, max %u ms; %u chained, %u passages, "
+          "%u pass timeouts, %u faults\n",
+          st.cycles, st.cycles ? static_cast<double>(st.totalCycleMs) / st.cycles : 0.0,
+          st.maxCycleMs, st.chained, st.passages, st.passTimeouts, r.faults);
+
+  double spanUs = static_cast<double>(r.spanUs);
+  fprintf(stderr, "%-8s | %-7s %5s | %6s | %9s %9s\n", "slot", "type", "level", "parks", "occupied", "reserved");
+  for (size_t i = 0; i < ParkingSlots::kSlots; i++) {
+    const SlotSpec& spec = ParkingLayout::kSlots[i];
+    fprintf(stderr, "%-8s | %-7s %5u | %6u | %8.1f%% %8.2f%%\n",
+            spec.name, kClassName[static_cast<size_t>(spec.type)], spec.level, r.slots[i].parks,
+            100.0 * r.slots[i].occupiedUs / spanUs, 100.0 * r.slots[i].reservedUs / spanUs);
+  }
+
+  if (r.mismatches > 0) {
+    fprintf(stderr, "WARNING: %u grants did not match the vehicle at the front of the lane\n", r.mismatches);
+  }
+}
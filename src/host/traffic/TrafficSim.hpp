@@ -0,0 +1,89 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+#include "core/Config.hpp"
+#include "app/AccessController.hpp"
+#include "app/SlotManager.hpp"
+
+// Simulador de tráfico de eventos discretos: el firmware real (setup() de
+// src/main.cpp, SlotManager, AccessController, Barrier) sobre el HAL
+// nativo, con vehículos que llegan, esperan en fila, pulsan, cruzan la
+// barrera, estacionan en el slot asignado y salen.
+//
+// El reloj virtual salta de evento en evento: el firmware duerme hasta su
+// próximo vencimiento y el simulador agenda cambios de entrada y despertares
+// (HostHal::scheduleWake) en los instantes exactos en que actúa un conductor.
+// Una semana corre en décimas de segundo.
+//
+// Modelo:
+//  - Llegadas Poisson por VehicleClass con una curva por hora del día
+//    (menos tráfico el fin de semana); estadía exponencial por clase.
+//    Params::rate escala todas las tasas. Params::tracePath reemplaza el
+//    modelo por un guion de líneas "<segundo> <VIP|CARGA|REGULAR> <estadía s>"
+//    ('#' comenta).
+//  - Dos filas físicas: entrada y salida. Sólo el primero de cada fila pulsa;
+//    el siguiente se acerca cuando el anterior arranca hacia la barrera.
+//    Con la fila de entrada llena, el que llega sigue de largo.
+//  - Con acceso concedido y la barrera abierta, el vehículo cruza el sensor
+//    de seguridad (reacción y cruce varían por conductor), va al slot
+//    asignado (sensor activo mientras está) y al terminar la estadía se suma
+//    a la fila de salida. Sin capacidad, se va.
+//
+// Todo lo aleatorio sale de Params::seed: la misma semilla da el mismo
+// resultado. Para dimensionar otro estacionamiento, cambiar ParkingLayout
+// (app/SlotLayout.hpp) y las tasas de TrafficSim.cpp.
+namespace TrafficSim {
+  constexpr size_t kClasses = 3;
+  extern const char* const kClassName[kClasses];
+
+  struct Params {
+    uint32_t hours{24 * 7};
+    uint64_t seed{1};
+    double rate{1.0};                 // Escala de las tasas de llegada
+    const char* tracePath{nullptr};   // Guion en lugar del modelo estocástico
+    bool verbose{false};              // Log del firmware a stdout
+    const char* recordPath{nullptr};  // Guardar la traza de entradas (host/replay)
+    Cfg::GateTiming timing{};         // Tiempos de barrera y FSM a usar
+  };
+
+  struct ClassResult {
+    uint32_t arrivals{0};
+    uint32_t balked{0};     // Fila de entrada llena
+    uint32_t denied{0};     // Sin capacidad
+    uint32_t entered{0};
+    std::vector<uint32_t> waitMs;   // Llegada -> acceso concedido
+  };
+
+  struct SlotResult {
+    uint32_t parks{0};
+    uint64_t occupiedUs{0};
+    uint64_t reservedUs{0};  // Acceso concedido -> vehículo en el slot
+  };
+
+  struct Result {
+    double wallS{0};
+    uint64_t loops{0};
+    size_t vehicles{0};
+    uint64_t spanUs{0};
+    ClassResult classes[kClasses];
+    std::vector<uint32_t> exitWaitMs;   // Llegada a la fila de salida -> acceso concedido
+    uint32_t exited{0};
+    uint32_t exitPending{0};            // En la fila de salida al terminar
+    std::vector<uint32_t> servedPerHour;
+    AccessController::Stats gate;
+    RequestQueue::Stats queue;
+    uint32_t queueAvgWaitMs{0};
+    uint32_t faults{0};
+    uint32_t mismatches{0};   // Acceso concedido a otra clase que la del primero de la fila
+    SlotResult slots[ParkingSlots::kSlots];
+  };
+
+  // Arranca el firmware (setup()) y simula p.hours. Una vez por hilo: el
+  // firmware no se reinicia; con SEMAFARO_TLS cada hilo tiene el suyo.
+  // false si no se pudo leer el guion o escribir la traza
+  bool run(const Params& p, Result& out);
+
+  // Reporte legible a stderr (ordena las demoras de 'r')
+  void printReport(const Params& p, Result& r);
+}
@@ -4,6 +4,11 @@
 // Core infrastructure
 #include "core/Scheduler.hpp"
 #include "core/Logger.hpp"
+#include "core/LogRing.hpp"
+#include "core/InputSampler.hpp"
+#include "core/EdgeCapture.hpp"
+#include "core/InputTrace.hpp"
+#include "core/Metrics.hpp"
 #include "core/Pins.hpp"
 #include "core/Config.hpp"
 
@@ -15,20 +20,55 @@
 // Application logic
 #include "app/SlotManager.hpp"
 #include "app/AccessController.hpp"
+#include "app/AppBus.hpp"
+#if TELEMETRY == TELEMETRY_BINARY
+#include "app/Telemetry.hpp"
+#endif
 
-// Global hardware instances
-Barrier barrier;
-ProximitySensor safeSensor;
-Button btnVip, btnCarga, btnReg, btnExit;
+// Global hardware instances (SEMAFARO_TLS: one firmware per host thread)
+SEMAFARO_TLS Barrier barrier;
+SEMAFARO_TLS ProximitySensor safeSensor;
+SEMAFARO_TLS ProximitySensor passLoop;   // Only with Cfg::PassSensor::LOOP
+SEMAFARO_TLS Button btnVip, btnCarga, btnReg, btnExit;
 
 // Application logic instances
-SlotManager slotManager;
-AccessController accessController;
+SEMAFARO_TLS ParkingSlots slotManager;
+SEMAFARO_TLS AccessController accessController;
+#if TELEMETRY == TELEMETRY_BINARY
+SEMAFARO_TLS Telemetry telemetry;
+#endif
 
 // Status tracking
-uint32_t lastStatusPrint = 0;
+SEMAFARO_TLS uint32_t lastStatusPrint = 0;
 const uint32_t STATUS_INTERVAL_MS = 30000; // Print status every 30 seconds
 
+// Control task (polling or event-driven, see LOOP_MODE)
+SEMAFARO_TLS Scheduler::TaskId controlTask = Scheduler::kInvalidTask;
+
+uint32_t controlStep() {
+  uint32_t now = millis();
+  
+  // One coherent read + debounce of every input for this step
+  InputSampler::sample();
+  
+  // Update all devices and logic
+  slotManager.update(now);
+  accessController.update(now);   // Barrier motion runs in its own task
+  barrier.checkSafety();          // ...but a safety edge reverses a closing barrier right away
+  
+  // Deliver this step's events (logging, telemetry) after the control logic
+  AppBus::dispatch();
+#if TELEMETRY == TELEMETRY_BINARY
+  telemetry.update(now);          // Delta frame if anything changed
+#endif
+  return now;
+}
+
+// Earliest time the control step has work without new input edges
+uint32_t msUntilControl(uint32_t now) {
+  return min(InputSampler::msUntilNext(), accessController.msUntilNext(now));
+}
+
 void printSystemStatus() {
   LOG_INFO("=== SEMAFARO SYSTEM STATUS ===");
   LOG_INFO("Uptime: %lu ms", millis());
@@ -37,17 +77,36 @@ void printSystemStatus() {
            barrier.isClosed() ? "CLOSED" :
            barrier.isOpen() ? "OPEN" :
            barrier.isMoving() ? "MOVING" : "FAULT");
+  barrier.printStats();
   
   slotManager.printStatus();
+  accessController.printStats(millis());
+  Scheduler::printStats();
   LOG_INFO("=============================");
 }
 
+// Serial commands, polled with the alive signal: 'T' dumps the input trace,
+// 'M' the metrics snapshot, 'S' requests a telemetry snapshot
+void pollSerialCommands() {
+  while (Serial.available() > 0) {
+    int c = Serial.read();
+    if (c == 'T') InputTrace::dump();
+    if (c == 'M') Metrics::dump();
+#if TELEMETRY == TELEMETRY_BINARY
+    if (c == 'S') telemetry.sendSnapshot(millis());
+#endif
+  }
+}
+
 void setup() {
   Serial.begin(115200);
   
   // Wait for serial to be ready
   delay(2000);
   
+  // Deferred logging drain (no-op with LOG_MODE_SYNC)
+  LogRing::begin();
+  
   LOG_INFO("=== SEMAFARO MVP Starting ===");
   LOG_INFO("ESP32-S3 Parking Control System");
   LOG_INFO("Version: 1.0.0 - MVP Implementation");
@@ -64,13 +123,18 @@ void setup() {
   // Initialize hardware devices
   LOG_INFO("Initializing hardware...");
   
-  // Barrier with safety sensor
-  barrier.begin(Pins::SERVO_PWM);
+  // Barrier with safety sensor (motion task at Cfg::kBarrierStepMs)
+  barrier.begin(Pins::SERVO_PWM, &safeSensor);
   barrier.setAngles(Cfg::kServoClosedDeg, Cfg::kServoOpenDeg);
   
   // Safety sensor
   safeSensor.begin(Pins::BARRIER_SAFE_IN, true, true); // PNP with pullup
   
+  // Vehicle passage detection: dedicated loop, or the safety sensor
+  if (Cfg::kPassSensor == Cfg::PassSensor::LOOP) {
+    passLoop.begin(Pins::PASS_LOOP_IN, true, true);
+  }
+  
   // Button inputs
   btnVip.begin(Pins::BTN_VIP_IN, true, true);     // Pullup, active-low
   btnCarga.begin(Pins::BTN_CARGA_IN, true, true);
@@ -85,34 +149,59 @@ void setup() {
   slotManager.begin();
   accessController.begin(&barrier, &slotManager, 
                         &btnVip, &btnCarga, &btnReg, &btnExit, 
-                        &safeSensor);
+                        &safeSensor,
+                        Cfg::kPassSensor == Cfg::PassSensor::LOOP ? &passLoop : nullptr);
+  
+#if TELEMETRY == TELEMETRY_BINARY
+  telemetry.begin(&accessController, &barrier, &slotManager);
+#endif
   
   LOG_INFO("Application logic initialized");
   
   // Setup scheduler tasks
   LOG_INFO("Setting up scheduler tasks...");
   
-  // Main control loop - 20Hz (50ms)
-  Scheduler::every(Cfg::kMainUpdateMs, []() {
-    uint32_t now = millis();
-    
-    // Update all devices and logic
-    slotManager.update(now);
-    accessController.update(now);
-    barrier.update(now, safeSensor.isDetected(now));
-  });
-  
+#if LOOP_MODE == LOOP_MODE_EVENT
+  // Main control step - on input edges and on the earliest pending deadline
+  controlTask = Scheduler::onDemand([]() {
+    uint32_t now = controlStep();
+    uint32_t waitMs = msUntilControl(now);
+    if (waitMs != kNoDeadline) Scheduler::runIn(controlTask, waitMs);
+  }, "control");
+  Scheduler::runIn(controlTask, 0);
+  EdgeCapture::setConsumer(controlTask);   // Input edges run the step right away
+  barrier.setConsumer(controlTask);        // So does the barrier reaching a position
+#else
+  // Main control loop - fixed 20Hz (50ms); edges are only queued
+  controlTask = Scheduler::every(Cfg::kMainUpdateMs, []() { controlStep(); }, "control");
+#endif
+  
+  // Input trace for host replay: from here on, every debounced input edge
+  // and FSM/barrier transition. Right after the control task so a replay
+  // sees the same polling phase
+  InputTrace::begin();
+  
+#if TELEMETRY == TELEMETRY_BINARY
+  // Telemetry keyframe - every 30 seconds (state changes go out as deltas)
+  Scheduler::every(STATUS_INTERVAL_MS, []() {
+    telemetry.sendSnapshot(millis());
+  }, "status");
+#else
   // Status monitoring - every 30 seconds
   Scheduler::every(STATUS_INTERVAL_MS, []() {
     printSystemStatus();
-  });
+  }, "status");
+#endif
   
-  // Watchdog-style alive signal - every 5 seconds
+  // Watchdog-style alive signal and serial commands - every 5 seconds
   Scheduler::every(5000, []() {
     LOG_DEBUG("System alive - free heap: %d bytes", ESP.getFreeHeap());
-  });
+    pollSerialCommands();
+  }, "alive");
   
   LOG_INFO("Scheduler configured");
+  Scheduler::printFootprint();
+  LOG_INFO("Metrics registry: %u bytes", (unsigned)Metrics::kFootprintBytes);
   
   // Print initial system status
   printSystemStatus();
@@ -125,9 +214,9 @@ void setup() {
 }
 
 void loop() {
-  // Execute all scheduled tasks
+  // Execute all due tasks
   Scheduler::tick();
   
-  // Small delay to prevent watchdog timeout
-  delay(1);
+  // Sleep until the next deadline (yields to the idle task / watchdog)
+  Scheduler::sleepUntilNext();
 }
\ No newline at end of file
@@ -0,0 +1,99 @@
+#!/usr/bin/env python3
+"""Genera el catálogo de formatos de log para LOG_MODE_CATALOG.
+
+Recorre src/ buscando llamadas LOG_ERR/LOG_WARN/LOG_INFO/LOG_DEBUG con un literal
+de formato y calcula el mismo id que core/LogCatalog.hpp (FNV-1a 32 bits sobre
+"prefijo + formato"). El JSON resultante se usa con:
+
+  python tools/log_decode.py /dev/ttyACM0 --catalog .pio/build/release/log_catalog.json
+
+Uso directo:
+  python tools/gen_log_catalog.py src -o log_catalog.json
+"""
+import argparse
+import json
+import os
+import re
+import sys
+
+PREFIXES = {
+    "LOG_ERR": "[ERROR] ",
+    "LOG_WARN": "[WARN ] ",
+    "LOG_INFO": "[INFO ] ",
+    "LOG_DEBUG": "[DEBUG] ",
+}
+
+CALL_RE = re.compile(r"\b(LOG_ERR|LOG_WARN|LOG_INFO|LOG_DEBUG)\s*\(\s*((?:\"(?:[^\"\\]|\\.)*\"\s*)+)")
+LITERAL_RE = re.compile(r"\"((?:[^\"\\]|\\.)*)\"")
+ESCAPES = {"n": "\n", "t": "\t", "r": "\r", "\\": "\\", "\"": "\"", "'": "'", "0": "\0"}
+
+
+def unescape(text):
+    out = []
+    i = 0
+    while i < len(text):
+        c = text[i]
+        if c == "\\" and i + 1 < len(text):
+            out.append(ESCAPES.get(text[i + 1], text[i + 1]))
+            i += 2
+        else:
+            out.append(c)
+            i += 1
+    return "".join(out)
+
+
+def fmt_id(text):
+    h = 2166136261
+    for b in text.encode("utf-8"):
+        h ^= b
+        h = (h * 16777619) & 0xFFFFFFFF
+    return 0xFFFFFFFE if h == 0xFFFFFFFF else h
+
+
+def build_catalog(src_dir):
+    """Retorna {id: formato}. Lanza ValueError si dos formatos distintos colisionan."""
+    catalog = {}
+    for root, _, files in os.walk(src_dir):
+        for name in sorted(files):
+            if not name.endswith((".cpp", ".hpp", ".h")):
+                continue
+            path = os.path.join(root, name)
+            with open(path, encoding="utf-8") as f:
+                source = f.read()
+            for m in CALL_RE.finditer(source):
+                text = PREFIXES[m.group(1)] + "".join(unescape(s) for s in LITERAL_RE.findall(m.group(2)))
+                key = fmt_id(text)
+                if key in catalog and catalog[key] != text:
+                    raise ValueError("log id collision 0x%08x: %r vs %r" % (key, catalog[key], text))
+                catalog[key] = text
+    return catalog
+
+
+def write_catalog(catalog, path):
+    os.makedirs(os.path.dirname(os.path.abspath(path)), exist_ok=True)
+    entries = {"0x%08x" % k: v for k, v in sorted(catalog.items())}
+    with open(path, "w", encoding="utf-8") as f:
+        json.dump({"version": 1, "formats": entries}, f, ensure_ascii=False, indent=1)
+
+
+def load_catalog(path):
+    with open(path, encoding="utf-8") as f:
+        data = json.load(f)
+    return {int(k, 16): v for k, v in data["formats"].items()}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("src", nargs="?", default="src")
+    parser.add_argument("-o", "--output", default="log_catalog.json")
+    opts = parser.parse_args()
+    try:
+        catalog = build_catalog(opts.src)
+    except ValueError as e:
+        sys.exit("error: %s" % e)
+    write_catalog(catalog, opts.output)
+    print("%u log formats -> %s" % (len(catalog), opts.output))
+
+
+if __name__ == "__main__":
+    main()
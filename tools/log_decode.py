@@ -0,0 +1,191 @@
+#!/usr/bin/env python3
+"""Decodifica el stream binario de logs de SEMAFARO (LOG_MODE BINARY o CATALOG).
+
+El firmware envía frames COBS delimitados por 0x00:
+  0x01 FORMAT   [fmtId u32][texto del formato]     (una vez por formato; no en CATALOG)
+  0x02 RECORD   [fmtId u32][tsMs u32][args...]
+  0x03 DROPPED  [count u32]                         (registros perdidos por ring lleno)
+
+Cada argumento es [tag u8][payload]: 1=i32 2=u32 3=i64 4=u64 5=f64 6=str(len u8 + bytes).
+7=truncado (sin payload): los argumentos siguientes no entraron en el registro.
+
+En modo CATALOG los textos vienen del catálogo generado en el build:
+  python tools/log_decode.py /dev/ttyACM0 --catalog .pio/build/release/log_catalog.json
+
+Uso:
+  python tools/log_decode.py captura.bin
+  python tools/log_decode.py /dev/ttyACM0 --baud 115200     (requiere pyserial)
+  pio device monitor --raw | python tools/log_decode.py -
+"""
+import argparse
+import re
+import struct
+import sys
+
+FRAME_FORMAT, FRAME_RECORD, FRAME_DROPPED = 0x01, 0x02, 0x03
+ARG_I32, ARG_U32, ARG_I64, ARG_U64, ARG_F64, ARG_STR, ARG_TRUNC = range(1, 8)
+
+SPEC_RE = re.compile(r"%%|%([-+ #0-9.]*)[hlLqjzt]*([a-zA-Z])")
+
+
+def cobs_decode(data):
+    out = bytearray()
+    i = 0
+    while i < len(data):
+        code = data[i]
+        if code == 0 or i + code > len(data):
+            raise ValueError("bad COBS frame")
+        out += data[i + 1:i + code]
+        i += code
+        if code < 0xFF and i < len(data):
+            out.append(0)
+    return bytes(out)
+
+
+def parse_args(payload):
+    args = []
+    i = 0
+    while i < len(payload):
+        tag = payload[i]
+        i += 1
+        if tag in (ARG_I32, ARG_U32):
+            if i + 4 > len(payload):
+                break
+            args.append(struct.unpack_from("<i" if tag == ARG_I32 else "<I", payload, i)[0])
+            i += 4
+        elif tag in (ARG_I64, ARG_U64):
+            if i + 8 > len(payload):
+                break
+            args.append(struct.unpack_from("<q" if tag == ARG_I64 else "<Q", payload, i)[0])
+            i += 8
+        elif tag == ARG_F64:
+            if i + 8 > len(payload):
+                break
+            args.append(struct.unpack_from("<d", payload, i)[0])
+            i += 8
+        elif tag == ARG_STR:
+            if i >= len(payload):
+                break
+            n = payload[i]
+            args.append(payload[i + 1:i + 1 + n].decode("utf-8", "replace"))
+            i += 1 + n
+        else:
+            break   # ARG_TRUNC: los que faltan se muestran como <?>
+    return args
+
+
+def format_printf(fmt, args):
+    """Formatea como el printf del firmware (sin modificadores de longitud)."""
+    it = iter(args)
+
+    def repl(m):
+        if m.group(0) == "%%":
+            return "%"
+        flags, conv = m.group(1), m.group(2)
+        try:
+            value = next(it)
+        except StopIteration:
+            return "<?>"
+        if conv == "u":
+            conv = "d"
+        if conv in "diouxXc" and isinstance(value, str):
+            conv = "s"
+        if conv == "s":
+            value = str(value)
+        try:
+            return ("%" + flags + conv) % value
+        except (TypeError, ValueError):
+            return str(value)
+
+    return SPEC_RE.sub(repl, fmt)
+
+
+class LogDecoder:
+    """Decodificador incremental: alimentar bytes con feed(), obtener líneas."""
+
+    def __init__(self, catalog=None):
+        self.formats = dict(catalog or {})
+        self.buffer = bytearray()
+        self.dropped = 0
+        self.bad_frames = 0
+
+    def feed(self, data):
+        self.buffer += data
+        lines = []
+        while True:
+            end = self.buffer.find(b"\x00")
+            if end < 0:
+                break
+            raw = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not raw:
+                continue
+            try:
+                line = self.handle_frame(cobs_decode(raw))
+            except (ValueError, struct.error, IndexError):
+                self.bad_frames += 1
+                continue
+            if line is not None:
+                lines.append(line)
+        return lines
+
+    def handle_frame(self, frame):
+        kind = frame[0]
+        if kind == FRAME_FORMAT:
+            fmt_id = struct.unpack_from("<I", frame, 1)[0]
+            self.formats[fmt_id] = frame[5:].decode("utf-8", "replace")
+            return None
+        if kind == FRAME_RECORD:
+            fmt_id, ts = struct.unpack_from("<II", frame, 1)
+            fmt = self.formats.get(fmt_id)
+            args = parse_args(frame[9:])
+            if fmt is None:
+                return "%10u <unknown format 0x%08x> %r" % (ts, fmt_id, args)
+            return "%10u %s" % (ts, format_printf(fmt, args))
+        if kind == FRAME_DROPPED:
+            count = struct.unpack_from("<I", frame, 1)[0]
+            self.dropped += count
+            return "%10s [WARN ] Log ring overflow: %u records dropped" % ("", count)
+        return None
+
+
+def open_source(path, baud):
+    if path == "-":
+        return sys.stdin.buffer
+    if path.startswith("/dev/") or path.upper().startswith("COM"):
+        import serial  # pyserial
+        return serial.Serial(path, baud, timeout=0.2)
+    return open(path, "rb")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="archivo, puerto serie o '-' para stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--catalog", help="log_catalog.json generado por tools/gen_log_catalog.py")
+    opts = parser.parse_args()
+
+    catalog = None
+    if opts.catalog:
+        from gen_log_catalog import load_catalog
+        catalog = load_catalog(opts.catalog)
+    decoder = LogDecoder(catalog)
+    src = open_source(opts.source, opts.baud)
+    try:
+        while True:
+            chunk = src.read(4096)
+            if not chunk:
+                if opts.source.startswith("/dev/") or opts.source.upper().startswith("COM"):
+                    continue
+                break
+            for line in decoder.feed(chunk):
+                print(line, flush=True)
+    except KeyboardInterrupt:
+        pass
+    if decoder.dropped or decoder.bad_frames:
+        print("# dropped records: %u, undecodable frames: %u" % (decoder.dropped, decoder.bad_frames),
+              file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()
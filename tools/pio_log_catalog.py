@@ -0,0 +1,14 @@
+# PlatformIO extra_script (pre): regenera $BUILD_DIR/log_catalog.json en cada build
+# para que el decodificador del host tenga los textos que el firmware no lleva.
+import os
+import sys
+
+Import("env")  # noqa: F821 (provisto por SCons)
+
+sys.path.insert(0, os.path.join(env["PROJECT_DIR"], "tools"))  # noqa: F821
+from gen_log_catalog import build_catalog, write_catalog  # noqa: E402
+
+_catalog = build_catalog(env.subst("$PROJECT_SRC_DIR"))  # noqa: F821
+_path = os.path.join(env.subst("$BUILD_DIR"), "log_catalog.json")  # noqa: F821
+write_catalog(_catalog, _path)
+print("Log catalog: %u formats -> %s" % (len(_catalog), _path))
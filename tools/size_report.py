@@ -0,0 +1,59 @@
+#!/usr/bin/env python3
+"""Compara secciones de dos ELF (antes/después), p. ej. SYNC vs release (LOG_MODE_CATALOG):
+
+  pio run -e 4d_systems_esp32s3_gen4_r8n16 && pio run -e release
+  python tools/size_report.py .pio/build/4d_systems_esp32s3_gen4_r8n16/firmware.elf \\
+                              .pio/build/release/firmware.elf
+
+Usa xtensa-esp32s3-elf-size si está en PATH o en ~/.platformio; si no, 'size' del host.
+"""
+import argparse
+import glob
+import os
+import shutil
+import subprocess
+
+SECTIONS = [".flash.rodata", ".rodata", ".flash.text", ".text", ".dram0.data", ".data", ".bss", ".dram0.bss"]
+
+
+def find_size_tool():
+    tool = shutil.which("xtensa-esp32s3-elf-size")
+    if tool:
+        return tool
+    pattern = os.path.expanduser("~/.platformio/packages/toolchain-xtensa-esp32s3/bin/xtensa-esp32s3-elf-size*")
+    found = glob.glob(pattern)
+    return found[0] if found else "size"
+
+
+def sections(tool, elf):
+    out = subprocess.check_output([tool, "-A", elf], text=True)
+    result = {}
+    for line in out.splitlines():
+        parts = line.split()
+        if len(parts) >= 2 and parts[0].startswith(".") and parts[1].isdigit():
+            result[parts[0]] = int(parts[1])
+    return result
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("before")
+    parser.add_argument("after")
+    parser.add_argument("--size-tool", default=None)
+    opts = parser.parse_args()
+
+    tool = opts.size_tool or find_size_tool()
+    a = sections(tool, opts.before)
+    b = sections(tool, opts.after)
+
+    print("%-16s %10s %10s %10s" % ("section", "before", "after", "delta"))
+    for name in SECTIONS:
+        if name in a or name in b:
+            x, y = a.get(name, 0), b.get(name, 0)
+            print("%-16s %10u %10u %+10d" % (name, x, y, y - x))
+    ta, tb = os.path.getsize(opts.before), os.path.getsize(opts.after)
+    print("%-16s %10u %10u %+10d" % ("(elf file)", ta, tb, tb - ta))
+
+
+if __name__ == "__main__":
+    main()
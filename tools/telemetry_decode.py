@@ -0,0 +1,222 @@
+#!/usr/bin/env python3
+"""Decodifica la telemetría binaria de SEMAFARO (-DTELEMETRY=1, app/Telemetry.hpp).
+
+El firmware envía frames COBS entre delimitadores 0x00, cada uno con
+  [tipo u8][seq u16][tiempo][payload][crc16 u16]      (enteros little-endian)
+  0x10 SNAPSHOT   tiempo u32 ms; estado completo (al conectar y cada 30 s)
+  0x11 DELTA      tiempo varint ms desde el frame anterior; sólo lo que cambió
+El CRC es CRC-16/CCITT-FALSE. Un salto en seq indica frames perdidos: el
+estado y el tiempo quedan inciertos hasta el próximo SNAPSHOT (desde un
+puerto serie se pide uno enseguida con 'S'). El texto de log y los
+frames de LogRing (0x01-0x03) que compartan el stream se ignoran.
+
+Uso:
+  python tools/telemetry_decode.py /dev/ttyACM0 --baud 115200   (requiere pyserial)
+  python tools/telemetry_decode.py captura.bin --json
+  .pio/build/native_telemetry/program | python tools/telemetry_decode.py -
+"""
+import argparse
+import json
+import struct
+import sys
+
+from log_decode import cobs_decode, open_source
+
+FRAME_SNAPSHOT, FRAME_DELTA = 0x10, 0x11
+FIELD_ACCESS, FIELD_BARRIER, FIELD_SLOT, FIELD_QUEUE, FIELD_ENTRIES, FIELD_EXITS, FIELD_DENIED = range(1, 8)
+
+ACCESS_STATES = ["IDLE", "CHECK_CAPACITY", "OPENING", "WAIT_PASS", "CLOSING", "FAULT"]
+BARRIER_STATES = ["CLOSED", "OPENING", "OPEN", "CLOSING", "FAULT"]
+SLOT_STATES = ["FREE", "OCCUPIED", "RESERVED", "?"]
+COUNTERS = {FIELD_QUEUE: "queue", FIELD_ENTRIES: "entries", FIELD_EXITS: "exits", FIELD_DENIED: "denied"}
+
+
+def crc16(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def read_varint(frame, i):
+    value = 0
+    shift = 0
+    while True:
+        b = frame[i]
+        i += 1
+        value |= (b & 0x7F) << shift
+        if not b & 0x80:
+            return value, i
+        shift += 7
+        if shift > 28:
+            raise ValueError("bad varint")
+
+
+def name(names, value):
+    return names[value] if value < len(names) else "?%u" % value
+
+
+class TelemetryDecoder:
+    """Decodificador incremental: alimentar bytes con feed(), obtener eventos.
+
+    Cada evento es un dict con el tipo de frame, seq, tiempo (None si se
+    desconoce), los cambios y una copia del estado resultante.
+    """
+
+    def __init__(self):
+        self.buffer = bytearray()
+        self.state = None          # None hasta el primer SNAPSHOT
+        self.time_ms = None        # None tras un salto hasta el próximo tiempo absoluto
+        self.next_seq = None
+        self.frames = 0
+        self.bytes = 0
+        self.lost = 0
+        self.bad_crc = 0
+        self.need_snapshot = False
+
+    def feed(self, data):
+        self.buffer += data
+        events = []
+        while True:
+            end = self.buffer.find(b"\x00")
+            if end < 0:
+                break
+            raw = bytes(self.buffer[:end])
+            del self.buffer[:end + 1]
+            if not raw:
+                continue
+            try:
+                frame = cobs_decode(raw)
+            except ValueError:
+                continue   # Texto de log
+            if len(frame) < 6 or frame[0] not in (FRAME_SNAPSHOT, FRAME_DELTA):
+                continue   # Texto o frames de LogRing
+            if crc16(frame[:-2]) != struct.unpack_from("<H", frame, len(frame) - 2)[0]:
+                self.bad_crc += 1
+                continue
+            try:
+                event = self.handle_frame(frame[:-2])
+            except (ValueError, IndexError, struct.error):
+                self.bad_crc += 1
+                continue
+            self.frames += 1
+            self.bytes += len(raw) + 2
+            events.append(event)
+        return events
+
+    def handle_frame(self, frame):
+        kind = frame[0]
+        seq = struct.unpack_from("<H", frame, 1)[0]
+        gap = 0
+        if self.next_seq is not None and seq != self.next_seq:
+            gap = (seq - self.next_seq) & 0xFFFF
+            self.lost += gap
+            self.time_ms = None
+            self.need_snapshot = True
+        self.next_seq = (seq + 1) & 0xFFFF
+
+        if kind == FRAME_DELTA:
+            dt, i = read_varint(frame, 3)
+            if self.time_ms is not None:
+                self.time_ms += dt
+        else:
+            self.time_ms = struct.unpack_from("<I", frame, 3)[0]
+            i = 7
+
+        event = {"type": "snapshot" if kind == FRAME_SNAPSHOT else "delta", "seq": seq, "time_ms": self.time_ms, "lost": gap}
+        if kind == FRAME_SNAPSHOT:
+            self.state = self.parse_snapshot(frame, i)
+            self.need_snapshot = False
+        else:
+            event["changes"] = self.apply_delta(frame, i)
+        event["synced"] = self.state is not None and not self.need_snapshot
+        event["state"] = None if self.state is None else json.loads(json.dumps(self.state))
+        return event
+
+    def parse_snapshot(self, frame, i):
+        state = {"access": name(ACCESS_STATES, frame[i]), "barrier": name(BARRIER_STATES, frame[i + 1])}
+        i += 2
+        for key in ("queue", "entries", "exits", "denied"):
+            state[key], i = read_varint(frame, i)
+        count, i = read_varint(frame, i)
+        if i + (count + 3) // 4 > len(frame):
+            raise ValueError("short snapshot")
+        state["slots"] = [SLOT_STATES[(frame[i + k // 4] >> (2 * (k % 4))) & 0x03] for k in range(count)]
+        return state
+
+    def apply_delta(self, frame, i):
+        changes = []
+        state = self.state if self.state is not None else {"slots": []}
+        while i < len(frame):
+            field = frame[i]
+            value, i = read_varint(frame, i + 1)
+            if field == FIELD_ACCESS:
+                state["access"] = name(ACCESS_STATES, value)
+                changes.append(("access", state["access"]))
+            elif field == FIELD_BARRIER:
+                state["barrier"] = name(BARRIER_STATES, value)
+                changes.append(("barrier", state["barrier"]))
+            elif field == FIELD_SLOT:
+                idx, slot = value >> 2, SLOT_STATES[value & 0x03]
+                slots = state["slots"]
+                if idx >= len(slots):
+                    slots.extend(["?"] * (idx + 1 - len(slots)))
+                slots[idx] = slot
+                changes.append(("slot%u" % idx, slot))
+            elif field in COUNTERS:
+                state[COUNTERS[field]] = value
+                changes.append((COUNTERS[field], value))
+            else:
+                changes.append(("field%u" % field, value))
+        if self.state is None:
+            self.state = state
+            self.need_snapshot = True
+        return changes
+
+
+def format_event(event):
+    t = "%10u" % event["time_ms"] if event["time_ms"] is not None else "%10s" % "?"
+    prefix = "%s #%-5u" % (t, event["seq"])
+    lost = " (%u frames lost)" % event["lost"] if event["lost"] else ""
+    state = event["state"]
+    if event["type"] == "snapshot":
+        slots = state["slots"]
+        return "%s snapshot%s: access=%s barrier=%s queue=%u entries=%u exits=%u denied=%u free=%u/%u" % (
+            prefix, lost, state["access"], state["barrier"], state["queue"], state["entries"],
+            state["exits"], state["denied"], slots.count("FREE"), len(slots))
+    changes = " ".join("%s=%s" % c for c in event["changes"])
+    return "%s %s%s%s" % (prefix, changes, lost, "" if event["synced"] else " (unsynced)")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("source", help="archivo, puerto serie o '-' para stdin")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--json", action="store_true", help="un objeto JSON por frame")
+    opts = parser.parse_args()
+
+    decoder = TelemetryDecoder()
+    src = open_source(opts.source, opts.baud)
+    serial_port = opts.source.startswith("/dev/") or opts.source.upper().startswith("COM")
+    requested = False
+    try:
+        while True:
+            chunk = src.read(4096)
+            if not chunk:
+                if serial_port:
+                    continue
+                break
+            for event in decoder.feed(chunk):
+                print(json.dumps(event) if opts.json else format_event(event), flush=True)
+            if serial_port and decoder.need_snapshot and not requested:
+                src.write(b"S")   # El firmware atiende comandos cada 5 s
+            requested = decoder.need_snapshot
+    except KeyboardInterrupt:
+        pass
+    print("# %u frames, %u bytes, %u lost, %u bad CRC" % (decoder.frames, decoder.bytes, decoder.lost,
+                                                          decoder.bad_crc), file=sys.stderr)
+
+
+if __name__ == "__main__":
+    main()